@@ -0,0 +1,647 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../src/sine.hpp"
+#include "../src/InitVulkan.hpp"
+#include "../src/svg.hpp"
+#include "../src/timebase.hpp"
+#include "../src/fft.hpp"
+#include "../src/curves.hpp"
+#include "../src/args.hpp"
+
+#ifndef TRIG_VERSION
+#define TRIG_VERSION "unknown"
+#endif
+
+// Headless benchmark suite, prints one JSON document so runs can be diffed between versions.
+// Every case uses fixed inputs and iteration counts, results are the median of several samples.
+
+// Counts heap allocations so a case can check what it allocates. Every form of operator new is replaced.
+// With glibc malloc and friends are replaced too, forwarding to glibc's own entry points, which also
+// catches allocations made by C code and the Vulkan driver. Elsewhere only operator new is seen
+static std::atomic<uint64_t> g_allocations{0};
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t t_size);
+void* __libc_calloc(size_t t_count, size_t t_size);
+void* __libc_realloc(void* t_pointer, size_t t_size);
+void* __libc_memalign(size_t t_alignment, size_t t_size);
+void __libc_free(void* t_pointer);
+
+void* malloc(size_t t_size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(t_size);
+}
+
+void* calloc(size_t t_count, size_t t_size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(t_count, t_size);
+}
+
+void* realloc(void* t_pointer, size_t t_size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(t_pointer, t_size);
+}
+
+void* memalign(size_t t_alignment, size_t t_size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(t_alignment, t_size);
+}
+
+void* aligned_alloc(size_t t_alignment, size_t t_size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(t_alignment, t_size);
+}
+
+int posix_memalign(void** t_pointer, size_t t_alignment, size_t t_size) {
+    if (t_alignment < sizeof(void*) || (t_alignment & (t_alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = __libc_memalign(t_alignment, t_size);
+    if (p == nullptr && t_size != 0) {
+        return ENOMEM;
+    }
+    *t_pointer = p;
+    return 0;
+}
+
+void free(void* t_pointer) {
+    __libc_free(t_pointer);
+}
+}
+
+// operator new goes to glibc directly so a single allocation isn't counted twice
+static void* rawAllocate(size_t t_size) {
+    return __libc_malloc(t_size);
+}
+
+static void* rawAllocateAligned(size_t t_size, size_t t_alignment) {
+    return __libc_memalign(t_alignment, t_size);
+}
+
+static void rawFree(void* t_pointer) {
+    __libc_free(t_pointer);
+}
+#else
+static void* rawAllocate(size_t t_size) {
+    return std::malloc(t_size);
+}
+
+static void* rawAllocateAligned(size_t t_size, size_t t_alignment) {
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(t_alignment, (t_size + t_alignment - 1) / t_alignment * t_alignment);
+}
+
+static void rawFree(void* t_pointer) {
+    std::free(t_pointer);
+}
+#endif
+
+static void* countedNew(size_t t_size) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return rawAllocate(t_size ? t_size : 1);
+}
+
+static void* countedNew(size_t t_size, std::align_val_t t_alignment) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return rawAllocateAligned(t_size ? t_size : 1, static_cast<size_t>(t_alignment));
+}
+
+void* operator new(size_t t_size) {
+    if (void* p = countedNew(t_size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t t_size) {
+    if (void* p = countedNew(t_size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t t_size, std::align_val_t t_alignment) {
+    if (void* p = countedNew(t_size, t_alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t t_size, std::align_val_t t_alignment) {
+    if (void* p = countedNew(t_size, t_alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t t_size, const std::nothrow_t&) noexcept {
+    return countedNew(t_size);
+}
+
+void* operator new[](size_t t_size, const std::nothrow_t&) noexcept {
+    return countedNew(t_size);
+}
+
+void* operator new(size_t t_size, std::align_val_t t_alignment, const std::nothrow_t&) noexcept {
+    return countedNew(t_size, t_alignment);
+}
+
+void* operator new[](size_t t_size, std::align_val_t t_alignment, const std::nothrow_t&) noexcept {
+    return countedNew(t_size, t_alignment);
+}
+
+void operator delete(void* t_pointer) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete[](void* t_pointer) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete(void* t_pointer, size_t) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete[](void* t_pointer, size_t) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete(void* t_pointer, std::align_val_t) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete[](void* t_pointer, std::align_val_t) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete(void* t_pointer, size_t, std::align_val_t) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete[](void* t_pointer, size_t, std::align_val_t) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete(void* t_pointer, const std::nothrow_t&) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete[](void* t_pointer, const std::nothrow_t&) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete(void* t_pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    rawFree(t_pointer);
+}
+
+void operator delete[](void* t_pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    rawFree(t_pointer);
+}
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        bool m_quick = false;
+        std::string m_outputPath;
+        uint32_t m_width = 800;
+        uint32_t m_height = 600;
+        uint32_t m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+        // Off unless asked for, the layer would dominate every Vulkan case
+        bool m_validation = false;
+    };
+
+    struct Result {
+        std::string m_name;
+        std::vector<std::pair<std::string, double>> m_params;
+        uint64_t m_iterations = 0;
+        double m_medianNs = 0.0;
+        double m_minNs = 0.0;
+        double m_throughput = 0.0;
+        std::string m_throughputUnit;
+    };
+
+    constexpr int SAMPLES = 5;
+
+    // Runs t_body t_iterations times per sample and writes the sorted per-iteration times of each sample
+    // to t_perIteration. Doesn't allocate when t_perIteration already has room for SAMPLES
+    template <typename Body>
+    void sample(uint64_t t_iterations, Body&& t_body, std::vector<double>& t_perIteration) {
+        t_perIteration.clear();
+        for (int s = 0; s < SAMPLES; ++s) {
+            auto start = Clock::now();
+            for (uint64_t i = 0; i < t_iterations; ++i) {
+                t_body(i);
+            }
+            auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            t_perIteration.push_back(elapsed / static_cast<double>(t_iterations));
+        }
+        std::sort(t_perIteration.begin(), t_perIteration.end());
+    }
+
+    template <typename Body>
+    std::vector<double> sample(uint64_t t_iterations, Body&& t_body) {
+        std::vector<double> perIteration;
+        perIteration.reserve(SAMPLES);
+        sample(t_iterations, t_body, perIteration);
+        return perIteration;
+    }
+
+    Result makeResult(const std::string& t_name, uint64_t t_iterations, const std::vector<double>& t_samples,
+                      double t_workPerIteration, const std::string& t_unit) {
+        Result r;
+        r.m_name = t_name;
+        r.m_iterations = t_iterations;
+        r.m_minNs = t_samples.front();
+        r.m_medianNs = t_samples[t_samples.size() / 2];
+        r.m_throughput = t_workPerIteration / (r.m_medianNs * 1e-9);
+        r.m_throughputUnit = t_unit;
+        return r;
+    }
+
+    // Scale iteration counts so every case handles roughly the same amount of work
+    uint64_t iterationsFor(uint64_t t_workPerIteration, uint64_t t_budget) {
+        return std::max<uint64_t>(1, t_budget / std::max<uint64_t>(1, t_workPerIteration));
+    }
+
+    // Vertices for t_curveCount curves of t_points each, laid out back to back.
+    // Every curve moves at its own speed, its phase is wrapped on its own
+    std::vector<Vertex> generateCurves(int t_curveCount, int t_points, timebase::Ticks t_time, std::vector<CurveRange>& t_ranges) {
+        std::vector<Vertex> vertices;
+        t_ranges.clear();
+        for (int c = 0; c < t_curveCount; ++c) {
+            float amplitude = 0.9f / static_cast<float>(t_curveCount) * static_cast<float>(c + 1);
+            float phase = timebase::phase(t_time, 1.0 + 0.5 * c);
+            auto curve = sine::generateSineWave(amplitude, 1.0f + 0.25f * static_cast<float>(c), phase, t_points);
+            t_ranges.push_back({static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(curve.size()), VertexDecode{}});
+            vertices.insert(vertices.end(), curve.begin(), curve.end());
+        }
+        return vertices;
+    }
+
+    // Timing is meaningless if the clock misbehaves: pausing, a long wait for events and resuming
+    // has to pick up exactly where it stopped, the way on-demand pacing drives it
+    bool checkClockResume() {
+        timebase::Clock clock;
+        const timebase::Ticks second = timebase::TICKS_PER_SECOND;
+        timebase::advance(clock, 0);
+        timebase::advance(clock, second);
+        const timebase::Ticks stopped = clock.m_now;
+        clock.m_paused = true;
+        timebase::advance(clock, 2 * second);
+        // unpaused by a key press before the next advance, after an hour of idling
+        clock.m_paused = false;
+        timebase::advance(clock, 3600 * second);
+        if (clock.m_now != stopped) {
+            std::cerr << "Error: resuming the clock jumped by " << timebase::toSeconds(clock.m_now - stopped) << " s" << std::endl;
+            return false;
+        }
+        timebase::advance(clock, 3601 * second);
+        return clock.m_now == stopped + second;
+    }
+
+    void benchGeneration(const Options& t_options, std::vector<Result>& t_results) {
+        const uint64_t budget = t_options.m_quick ? 2'000'000 : 20'000'000;
+        for (int points : {200, 1'000, 10'000, 100'000, 1'000'000}) {
+            uint64_t iterations = iterationsFor(points, budget);
+            size_t sink = 0;
+            auto samples = sample(iterations, [&](uint64_t i) {
+                auto vertices = sine::generateSineWave(0.5f, 1.0f, static_cast<float>(i) * 0.01f, points);
+                sink += vertices.size();
+            });
+            if (sink == 0) {
+                std::cerr << "generation produced no vertices" << std::endl;
+            }
+            Result r = makeResult("generate_sine_wave", iterations, samples, points, "points/s");
+            r.m_params.push_back({"points", points});
+            t_results.push_back(r);
+        }
+    }
+
+    // Discards everything written to it, keeps file system speed out of the export numbers
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int t_c) override { return t_c; }
+        std::streamsize xsputn(const char*, std::streamsize t_count) override { return t_count; }
+    };
+
+    void benchSvgExport(const Options& t_options, std::vector<Result>& t_results) {
+        const uint64_t budget = t_options.m_quick ? 2'000'000 : 20'000'000;
+        NullBuffer nullBuffer;
+        std::ostream out(&nullBuffer);
+        for (int points : {10'000, 1'000'000}) {
+            sine::SineParams params;
+            params.m_pointCount = points;
+            std::vector<uint8_t> data;
+            VertexDecode decode = sine::generateSineWave(params, VertexFormat::FLOAT2, data);
+            std::vector<CurveRange> curves{{0, static_cast<uint32_t>(points), decode}};
+
+            svg::Options svgOptions;
+            svgOptions.m_width = t_options.m_width;
+            svgOptions.m_height = t_options.m_height;
+            svg::Stats stats;
+            uint64_t iterations = iterationsFor(points, budget);
+            auto samples = sample(iterations, [&](uint64_t) {
+                stats = svg::write(out, svgOptions, data.data(), VertexFormat::FLOAT2, curves);
+            });
+            Result r = makeResult("svg_export", iterations, samples, points, "points/s");
+            r.m_params.push_back({"points", points});
+            r.m_params.push_back({"tolerance_px", svgOptions.m_tolerance});
+            r.m_params.push_back({"output_points", static_cast<double>(stats.m_outputPoints)});
+            t_results.push_back(r);
+        }
+    }
+
+    // The spectrum mode's per-frame CPU work: windowed FFT of the curve plus the dB conversion
+    void benchSpectrum(const Options& t_options, std::vector<Result>& t_results) {
+        const uint64_t budget = t_options.m_quick ? 2'000'000 : 20'000'000;
+        for (int points : {1'024, 65'536, 1'048'576}) {
+            sine::SineParams params;
+            params.m_pointCount = points;
+            std::vector<float> samples(static_cast<size_t>(points));
+            sine::sampleSineWave(params, samples);
+
+            fft::Plan plan;
+            fft::prepare(plan, samples.size(), fft::Window::HANN);
+            std::vector<float> decibels(fft::binCount(plan));
+            uint64_t iterations = iterationsFor(points, budget);
+            auto samplesNs = sample(iterations, [&](uint64_t) {
+                fft::amplitudeSpectrum(plan, samples, decibels);
+            });
+            Result r = makeResult("fft_spectrum", iterations, samplesNs, points, "points/s");
+            r.m_params.push_back({"points", points});
+            r.m_params.push_back({"bins", static_cast<double>(decibels.size())});
+            t_results.push_back(r);
+        }
+    }
+
+    void benchUpload(VulkanContext& t_context, const Options& t_options, std::vector<Result>& t_results) {
+        const uint64_t budget = t_options.m_quick ? 2'000'000 : 20'000'000;
+        for (int points : {200, 10'000, 1'000'000}) {
+            auto vertices = sine::generateSineWave(0.5f, 1.0f, 0.0f, points);
+            // the first upload grows the buffer, keep that out of the measurement
+            InitVulkan::uploadVertices(t_context, vertices);
+
+            uint64_t iterations = iterationsFor(points, budget);
+            auto samples = sample(iterations, [&](uint64_t) {
+                InitVulkan::uploadVertices(t_context, vertices);
+            });
+            double bytes = static_cast<double>(points) * sizeof(Vertex);
+            Result r = makeResult("upload_vertices", iterations, samples, bytes, "bytes/s");
+            r.m_params.push_back({"points", points});
+            r.m_params.push_back({"bytes", bytes});
+            t_results.push_back(r);
+        }
+    }
+
+    // Generation straight into each compact layout plus its upload, the bytes moved per point differ 2-4x
+    void benchVertexFormats(VulkanContext& t_context, const Options& t_options, std::vector<Result>& t_results) {
+        const std::pair<VertexFormat, const char*> formats[] = {
+            {VertexFormat::FLOAT2, "float2"},
+            {VertexFormat::HALF2, "half2"},
+            {VertexFormat::FLOAT_Y, "float_y"},
+            {VertexFormat::HALF_Y, "half_y"},
+            {VertexFormat::SNORM16_Y, "snorm16_y"},
+        };
+        const uint64_t iterations = t_options.m_quick ? 5 : 50;
+        sine::SineParams params;
+        params.m_pointCount = 1'000'000;
+
+        for (const auto& [format, name] : formats) {
+            std::vector<uint8_t> data;
+            sine::generateSineWave(params, format, data);
+            InitVulkan::uploadVertices(t_context, data.data(), data.size());
+
+            auto samples = sample(iterations, [&](uint64_t i) {
+                data.clear();
+                params.m_phase = static_cast<float>(i) * 0.01f;
+                sine::generateSineWave(params, format, data);
+                InitVulkan::uploadVertices(t_context, data.data(), data.size());
+            });
+            Result r = makeResult(std::string("generate_upload_") + name, iterations, samples, params.m_pointCount, "points/s");
+            r.m_params.push_back({"points", params.m_pointCount});
+            r.m_params.push_back({"bytes_per_vertex", static_cast<double>(sine::vertexStride(format))});
+            t_results.push_back(r);
+        }
+    }
+
+    void benchRecording(VulkanContext& t_context, const Options& t_options, std::vector<Result>& t_results) {
+        vkDeviceWaitIdle(t_context.m_device);
+        const uint64_t iterations = t_options.m_quick ? 200 : 2'000;
+        for (int curveCount : {1, 16, 256}) {
+            std::vector<CurveRange> ranges;
+            auto vertices = generateCurves(curveCount, 1'000, 0, ranges);
+            InitVulkan::uploadVertices(t_context, vertices);
+
+            // includes the reset of the frame slot's command pool
+            auto samples = sample(iterations, [&](uint64_t) {
+                uint32_t slot = InitVulkan::beginFrame(t_context);
+                InitVulkan::recordCommandBuffer(t_context, t_context.m_windows.front(), slot, ranges);
+            });
+            Result r = makeResult("record_command_buffer", iterations, samples, 1.0, "records/s");
+            r.m_params.push_back({"curves", curveCount});
+            t_results.push_back(r);
+        }
+    }
+
+    void benchFrames(VulkanContext& t_context, const Options& t_options, std::vector<Result>& t_results) {
+        const uint64_t frames = t_options.m_quick ? 30 : 300;
+        for (int curveCount : {1, 4, 16, 64}) {
+            std::vector<CurveRange> ranges;
+            // warm up so buffer growth and driver caches are settled
+            for (uint32_t i = 0; i < t_context.m_framesInFlight; ++i) {
+                auto vertices = generateCurves(curveCount, 1'000, 0, ranges);
+                InitVulkan::renderFrame(t_context, vertices, ranges);
+            }
+            vkDeviceWaitIdle(t_context.m_device);
+
+            auto samples = sample(frames, [&](uint64_t i) {
+                // fixed timestep so every run draws the same frames
+                auto vertices = generateCurves(curveCount, 1'000, timebase::frameTime(i, 60), ranges);
+                InitVulkan::renderFrame(t_context, vertices, ranges);
+                if (i + 1 == frames) {
+                    vkDeviceWaitIdle(t_context.m_device);
+                }
+            });
+            Result r = makeResult("end_to_end_frame", frames, samples, 1.0, "frames/s");
+            r.m_params.push_back({"curves", curveCount});
+            r.m_params.push_back({"points_per_curve", 1'000});
+            r.m_params.push_back({"frames_in_flight", t_context.m_framesInFlight});
+            t_results.push_back(r);
+        }
+    }
+
+    // The interactive loop with the spectrum shown: arena reset, sine and spectrum generation with
+    // arena scratch, upload and draw. Once warmed up none of it may touch the heap, returns false when it did
+    bool benchSteadyState(VulkanContext& t_context, const Options& t_options, std::vector<Result>& t_results) {
+        const uint64_t frames = t_options.m_quick ? 30 : 300;
+        sine::SineParams params;
+        params.m_pointCount = 65'536;
+        curves::Spectrum spectrum;
+        spectrum.m_enabled = true;
+        std::vector<uint8_t> vertexData;
+        std::vector<CurveRange> frameCurves;
+
+        auto frame = [&](uint64_t t_frame) {
+            t_context.m_frameArena.reset();
+            params.m_phase = timebase::phase(timebase::frameTime(t_frame, 60), 1.0);
+            curves::generate(params, spectrum, t_context.m_vertexFormat, t_context.m_frameArena, vertexData, frameCurves);
+            InitVulkan::uploadVertices(t_context, vertexData.data(), vertexData.size());
+            InitVulkan::drawFrame(t_context, frameCurves);
+        };
+
+        // the first frames grow the arena, the vectors and the vertex buffer
+        for (uint64_t i = 0; i < 2 * t_context.m_framesInFlight; ++i) {
+            frame(i);
+        }
+        vkDeviceWaitIdle(t_context.m_device);
+
+        // sized before counting starts, so everything counted below comes from the frames
+        std::vector<double> samples;
+        samples.reserve(SAMPLES);
+        const uint64_t before = g_allocations.load(std::memory_order_relaxed);
+        sample(frames, [&](uint64_t i) { frame(i); }, samples);
+        const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - before;
+        vkDeviceWaitIdle(t_context.m_device);
+
+        const double perFrame = static_cast<double>(allocations) / static_cast<double>(frames * SAMPLES);
+        if (allocations > 0) {
+            std::cerr << "Error: steady state frames allocate " << perFrame << " times per frame" << std::endl;
+        }
+        Result r = makeResult("steady_state_frame", frames, samples, 1.0, "frames/s");
+        r.m_params.push_back({"points", params.m_pointCount});
+        r.m_params.push_back({"allocations_per_frame", perFrame});
+        r.m_params.push_back({"arena_peak_bytes", static_cast<double>(t_context.m_frameArena.peakBytes())});
+        t_results.push_back(r);
+        return allocations == 0;
+    }
+
+    std::string escapeJson(const std::string& t_text) {
+        std::string out;
+        for (char c : t_text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    void writeJson(std::ostream& t_out, const std::string& t_device, const Options& t_options, const std::vector<Result>& t_results) {
+        t_out << "{\n";
+        t_out << "  \"benchmark\": \"trig_bench\",\n";
+        t_out << "  \"version\": \"" << TRIG_VERSION << "\",\n";
+        t_out << "  \"device\": \"" << escapeJson(t_device) << "\",\n";
+        t_out << "  \"quick\": " << (t_options.m_quick ? "true" : "false") << ",\n";
+        t_out << "  \"validation\": " << (t_options.m_validation ? "true" : "false") << ",\n";
+        t_out << "  \"extent\": [" << t_options.m_width << ", " << t_options.m_height << "],\n";
+        t_out << "  \"results\": [\n";
+        for (size_t i = 0; i < t_results.size(); ++i) {
+            const Result& r = t_results[i];
+            t_out << "    {\"name\": \"" << r.m_name << "\", \"params\": {";
+            for (size_t p = 0; p < r.m_params.size(); ++p) {
+                t_out << (p ? ", " : "") << "\"" << r.m_params[p].first << "\": " << r.m_params[p].second;
+            }
+            t_out << "}, \"iterations\": " << r.m_iterations
+                  << ", \"median_ns\": " << r.m_medianNs
+                  << ", \"min_ns\": " << r.m_minNs
+                  << ", \"throughput\": " << r.m_throughput
+                  << ", \"unit\": \"" << r.m_throughputUnit << "\"}"
+                  << (i + 1 < t_results.size() ? "," : "") << "\n";
+        }
+        t_out << "  ]\n";
+        t_out << "}\n";
+    }
+
+    bool parseOptions(int argc, char** argv, Options& t_options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--quick") {
+                t_options.m_quick = true;
+            } else if (arg == "--output" && i + 1 < argc) {
+                t_options.m_outputPath = argv[++i];
+            } else if (arg == "--extent" && i + 2 < argc && args::parseWhole(argv[i + 1], 1u, t_options.m_width) &&
+                       args::parseWhole(argv[i + 2], 1u, t_options.m_height)) {
+                i += 2;
+            } else if (arg == "--frames-in-flight" && i + 1 < argc &&
+                       args::parseWhole(argv[i + 1], 1u, t_options.m_framesInFlight)) {
+                ++i;
+            } else if (arg == "--validation" && VULKAN_DEBUG_BUILD) {
+                t_options.m_validation = true;
+            } else {
+                std::cerr << "Usage: trig_bench [--quick] [--output <file.json>] [--extent <width> <height>] [--frames-in-flight <n>]"
+                          << (VULKAN_DEBUG_BUILD ? " [--validation]" : "") << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+
+    VulkanContext m_vulkanContext;
+    std::vector<Result> results;
+    std::string deviceName;
+    // still written out when it fails, the results show how much it allocates
+    bool steadyStateClean = false;
+
+    if (!checkClockResume()) {
+        return -1;
+    }
+
+    try {
+        benchGeneration(options, results);
+        benchSvgExport(options, results);
+        benchSpectrum(options, results);
+
+        // Render into offscreen images so the suite runs without a display (e.g. on lavapipe)
+        m_vulkanContext.m_framesInFlight = options.m_framesInFlight;
+        m_vulkanContext.m_debug.m_requested = options.m_validation;
+        InitVulkan::initializeHeadless(m_vulkanContext, options.m_width, options.m_height);
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(m_vulkanContext.m_physicalDevice, &props);
+        deviceName = props.deviceName;
+
+        benchUpload(m_vulkanContext, options, results);
+        benchVertexFormats(m_vulkanContext, options, results);
+        benchRecording(m_vulkanContext, options, results);
+        benchFrames(m_vulkanContext, options, results);
+        steadyStateClean = benchSteadyState(m_vulkanContext, options, results);
+
+        InitVulkan::cleanup(m_vulkanContext);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        InitVulkan::cleanup(m_vulkanContext);
+        return -1;
+    }
+
+    if (options.m_outputPath.empty()) {
+        writeJson(std::cout, deviceName, options, results);
+    } else {
+        std::ofstream file(options.m_outputPath);
+        if (!file.is_open()) {
+            std::cerr << "Error: failed to open " << options.m_outputPath << std::endl;
+            return -1;
+        }
+        writeJson(file, deviceName, options, results);
+    }
+
+    return steadyStateClean ? 0 : -1;
+}
@@ -1,10 +1,312 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <GLFW/glfw3.h>
 
 #include "src/sine.hpp"
 #include "src/InitVulkan.hpp"
+#include "src/pacing.hpp"
+#include "src/dirty.hpp"
+#include "src/view.hpp"
+#include "src/FrameExport.hpp"
+#include "src/svg.hpp"
+#include "src/timebase.hpp"
+#include "src/fft.hpp"
+#include "src/curves.hpp"
+#include "src/args.hpp"
+
+// Zoom factor applied per scroll wheel step
+constexpr float ZOOM_STEP = 1.1f;
+// How fast the wave moves, in radians of phase per second of animation time
+constexpr double PHASE_SPEED = 1.0;
+// State shared with the GLFW callbacks of all windows
+struct AppState {
+    pacing::FramePacer m_pacer;
+    dirty::Tracker m_tracker;
+    sine::SineParams m_params;
+    // Animation time, paused clocks hold the phase
+    timebase::Clock m_clock;
+    curves::Spectrum m_spectrum;
+    uint32_t m_svgCount = 0;
+};
+
+// State of one window, its GLFW user pointer. Windows pan and zoom independently
+struct WindowState {
+    AppState* m_app = nullptr;
+    GLFWwindow* m_handle = nullptr;
+    view::ViewTransform m_view;
+    bool m_dragging = false;
+    glm::vec2 m_lastCursor = glm::vec2(0.0f);
+    bool m_framebufferResized = false;
+    bool m_svgRequested = false;
+};
+
+static void printUsage() {
+    std::cerr << "Usage: Trigonometricly [--present-mode immediate|mailbox|fifo|fifo-relaxed] [--fps <limit>] [--on-demand]\n"
+              << "                       [--fixed-step <fps>]\n"
+              << "                       [--vertex-format float2|half2|float-y|half-y|snorm16-y]\n"
+              << "                       [--export <dir|file.y4m|file.svg> [--frames <n>] [--export-fps <n>] [--export-size <w> <h>] [--export-threads <n>]]\n"
+              << "                       [--svg-tolerance <pixels>] [--windows <n>] [--points <n>]\n"
+              << "                       [--frames-in-flight <n>]\n"
+              << "                       [--spectrum hann|blackman|rectangular] [--validation on|off]\n"
+              << "  --on-demand  only redraw on input or resize, the animation starts paused (space toggles it)\n"
+              << "  --fixed-step advance the animation by exactly 1/fps per frame instead of by wall time\n"
+              << "  --windows    open n windows drawing the same curve from one device, each with its own view\n"
+              << "  --export     render frames without a window, PNG files into a directory or one Y4M video,\n"
+              << "               an .svg path writes the first frame as simplified vector paths instead\n"
+              << "  --spectrum   also draw the windowed amplitude spectrum of the curve (F toggles it)\n"
+              << "  --validation Vulkan validation layer and object names, on by default in builds with TRIG_VULKAN_DEBUG\n"
+              << "  Drag to pan, scroll to zoom, R resets the view, S saves the current frame as SVG" << std::endl;
+}
+
+static bool parseVertexFormat(const std::string& t_name, VertexFormat& t_format) {
+    if (t_name == "float2") t_format = VertexFormat::FLOAT2;
+    else if (t_name == "half2") t_format = VertexFormat::HALF2;
+    else if (t_name == "float-y") t_format = VertexFormat::FLOAT_Y;
+    else if (t_name == "half-y") t_format = VertexFormat::HALF_Y;
+    else if (t_name == "snorm16-y") t_format = VertexFormat::SNORM16_Y;
+    else return false;
+    return true;
+}
+
+static bool parseSpectrumWindow(const std::string& t_name, fft::Window& t_window) {
+    if (t_name == "hann") t_window = fft::Window::HANN;
+    else if (t_name == "blackman") t_window = fft::Window::BLACKMAN;
+    else if (t_name == "rectangular") t_window = fft::Window::RECTANGULAR;
+    else return false;
+    return true;
+}
+
+static bool parseOnOff(const std::string& t_name, bool& t_value) {
+    if (t_name == "on") t_value = true;
+    else if (t_name == "off") t_value = false;
+    else return false;
+    return true;
+}
+
+static bool parsePresentMode(const std::string& t_name, VkPresentModeKHR& t_mode) {
+    if (t_name == "immediate") t_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    else if (t_name == "mailbox") t_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+    else if (t_name == "fifo") t_mode = VK_PRESENT_MODE_FIFO_KHR;
+    else if (t_name == "fifo-relaxed") t_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    else return false;
+    return true;
+}
+
+static void keyCallback(GLFWwindow* t_window, int t_key, int, int t_action, int) {
+    if (t_action == GLFW_RELEASE) {
+        return;
+    }
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    AppState* state = window->m_app;
+    switch (t_key) {
+        case GLFW_KEY_SPACE: state->m_clock.m_paused = !state->m_clock.m_paused; break;
+        case GLFW_KEY_UP: state->m_params.m_amplitude += 0.05f; break;
+        case GLFW_KEY_DOWN: state->m_params.m_amplitude -= 0.05f; break;
+        case GLFW_KEY_RIGHT: state->m_params.m_frequency += 0.25f; break;
+        case GLFW_KEY_LEFT: state->m_params.m_frequency -= 0.25f; break;
+        case GLFW_KEY_R: window->m_view = view::ViewTransform{}; break;
+        case GLFW_KEY_S: window->m_svgRequested = true; break;
+        case GLFW_KEY_F: state->m_spectrum.m_enabled = !state->m_spectrum.m_enabled; break;
+        case GLFW_KEY_ESCAPE: glfwSetWindowShouldClose(t_window, GLFW_TRUE); break;
+        default: return;
+    }
+    pacing::requestRedraw(state->m_pacer);
+}
+
+static glm::vec2 cursorToClip(GLFWwindow* t_window, double t_x, double t_y) {
+    int width, height;
+    glfwGetWindowSize(t_window, &width, &height);
+    return view::windowToClip(t_x, t_y, std::max(width, 1), std::max(height, 1));
+}
+
+static void scrollCallback(GLFWwindow* t_window, double, double t_yOffset) {
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    double x, y;
+    glfwGetCursorPos(t_window, &x, &y);
+    view::zoomAt(window->m_view, cursorToClip(t_window, x, y), std::pow(ZOOM_STEP, static_cast<float>(t_yOffset)));
+    pacing::requestRedraw(window->m_app->m_pacer);
+}
+
+static void mouseButtonCallback(GLFWwindow* t_window, int t_button, int t_action, int) {
+    if (t_button != GLFW_MOUSE_BUTTON_LEFT) {
+        return;
+    }
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    window->m_dragging = t_action == GLFW_PRESS;
+    double x, y;
+    glfwGetCursorPos(t_window, &x, &y);
+    window->m_lastCursor = cursorToClip(t_window, x, y);
+}
+
+static void cursorPosCallback(GLFWwindow* t_window, double t_x, double t_y) {
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    if (!window->m_dragging) {
+        return;
+    }
+    glm::vec2 cursor = cursorToClip(t_window, t_x, t_y);
+    view::pan(window->m_view, cursor - window->m_lastCursor);
+    window->m_lastCursor = cursor;
+    pacing::requestRedraw(window->m_app->m_pacer);
+}
+
+// The window contents were lost (e.g. uncovered), so the last frame has to be drawn again
+static void refreshCallback(GLFWwindow* t_window) {
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    dirty::mark(window->m_app->m_tracker, dirty::SWAPCHAIN);
+    pacing::requestRedraw(window->m_app->m_pacer);
+}
+
+static void framebufferSizeCallback(GLFWwindow* t_window, int, int) {
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    window->m_framebufferResized = true;
+    refreshCallback(t_window);
+}
+
+// Closing a secondary window only takes effect in the main loop, which has to get past the pacing gate for it
+static void closeCallback(GLFWwindow* t_window) {
+    auto* window = static_cast<WindowState*>(glfwGetWindowUserPointer(t_window));
+    pacing::requestRedraw(window->m_app->m_pacer);
+}
+
+static GLFWwindow* createWindow(WindowState& t_state, const std::string& t_title) {
+    GLFWwindow* window = glfwCreateWindow(800, 600, t_title.c_str(), nullptr, nullptr);
+    if (!window) {
+        return nullptr;
+    }
+    t_state.m_handle = window;
+    glfwSetWindowUserPointer(window, &t_state);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetWindowRefreshCallback(window, refreshCallback);
+    glfwSetWindowCloseCallback(window, closeCallback);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    return window;
+}
+
+static bool endsWith(const std::string& t_string, const std::string& t_suffix) {
+    return t_string.size() >= t_suffix.size() && t_string.compare(t_string.size() - t_suffix.size(), t_suffix.size(), t_suffix) == 0;
+}
+
+static bool writeSvg(const std::string& t_path, const svg::Options& t_options, const std::vector<uint8_t>& t_vertexData,
+                     VertexFormat t_format, const std::vector<CurveRange>& t_curves) {
+    try {
+        std::ofstream file(t_path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open " + t_path);
+        }
+        auto start = std::chrono::steady_clock::now();
+        svg::Stats stats = svg::write(file, t_options, t_vertexData.data(), t_format, t_curves);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote " << t_path << ": " << stats.m_outputPoints << " of " << stats.m_inputPoints
+                  << " points in " << ms << " ms" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static int runExport(FrameExport::Settings& t_settings, svg::Options& t_svgOptions, curves::Spectrum& t_spectrum) {
+    // Vector output needs no GPU, the curves are generated and simplified on the CPU
+    if (endsWith(t_settings.m_outputPath, ".svg")) {
+        std::vector<uint8_t> vertexData;
+        std::vector<CurveRange> curves;
+        FrameArena arena;
+        curves::generate(t_settings.m_params, t_spectrum, t_settings.m_vertexFormat, arena, vertexData, curves);
+        t_svgOptions.m_width = t_settings.m_width;
+        t_svgOptions.m_height = t_settings.m_height;
+        return writeSvg(t_settings.m_outputPath, t_svgOptions, vertexData, t_settings.m_vertexFormat, curves) ? 0 : -1;
+    }
+
+    t_settings.m_format = endsWith(t_settings.m_outputPath, ".y4m") ? FrameExport::Format::Y4M : FrameExport::Format::PNG;
+    try {
+        FrameExport::Stats stats = FrameExport::run(t_settings);
+        std::cout << "Exported " << stats.m_frames << " frames to " << t_settings.m_outputPath
+                  << " in " << stats.m_seconds << " s (" << stats.m_frames / std::max(stats.m_seconds, 1e-9) << " fps)\n"
+                  << "  waited on GPU " << stats.m_gpuWaitSeconds << " s, on writers " << stats.m_writerWaitSeconds << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    AppState m_appState;
+    VulkanContext m_vulkanContext;
+    FrameExport::Settings exportSettings;
+    svg::Options svgOptions;
+    int windowCount = 1;
+    double fixedStepFps = 0.0;
+    double svgTolerance = svgOptions.m_tolerance;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--present-mode" && i + 1 < argc && parsePresentMode(argv[i + 1], m_vulkanContext.m_preferredPresentMode)) {
+            ++i;
+        } else if (arg == "--vertex-format" && i + 1 < argc && parseVertexFormat(argv[i + 1], m_vulkanContext.m_vertexFormat)) {
+            ++i;
+        } else if (arg == "--fps" && i + 1 < argc && args::parseReal(argv[i + 1], m_appState.m_pacer.m_targetFps)) {
+            ++i;
+        } else if (arg == "--fixed-step" && i + 1 < argc && args::parseReal(argv[i + 1], fixedStepFps)) {
+            m_appState.m_clock.m_fixedStep = timebase::frameDuration(fixedStepFps);
+            ++i;
+        } else if (arg == "--on-demand") {
+            m_appState.m_pacer.m_onDemand = true;
+            m_appState.m_clock.m_paused = true;
+        } else if (arg == "--export" && i + 1 < argc) {
+            exportSettings.m_outputPath = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc && args::parseWhole(argv[i + 1], 0u, exportSettings.m_frameCount)) {
+            ++i;
+        } else if (arg == "--export-fps" && i + 1 < argc && args::parseWhole(argv[i + 1], 1u, exportSettings.m_fps)) {
+            ++i;
+        } else if (arg == "--export-size" && i + 2 < argc && args::parseWhole(argv[i + 1], 1u, exportSettings.m_width) &&
+                   args::parseWhole(argv[i + 2], 1u, exportSettings.m_height)) {
+            i += 2;
+        } else if (arg == "--export-threads" && i + 1 < argc && args::parseWhole(argv[i + 1], 0u, exportSettings.m_writerThreads)) {
+            ++i;
+        } else if (arg == "--windows" && i + 1 < argc && args::parseWhole(argv[i + 1], 1, windowCount)) {
+            ++i;
+        } else if (arg == "--svg-tolerance" && i + 1 < argc && args::parseReal(argv[i + 1], svgTolerance)) {
+            svgOptions.m_tolerance = static_cast<float>(svgTolerance);
+            ++i;
+        } else if (arg == "--frames-in-flight" && i + 1 < argc && args::parseWhole(argv[i + 1], 1u, m_vulkanContext.m_framesInFlight)) {
+            ++i;
+        } else if (arg == "--points" && i + 1 < argc && args::parseWhole(argv[i + 1], 2, m_appState.m_params.m_pointCount)) {
+            ++i;
+        } else if (arg == "--spectrum" && i + 1 < argc && parseSpectrumWindow(argv[i + 1], m_appState.m_spectrum.m_window)) {
+            m_appState.m_spectrum.m_enabled = true;
+            ++i;
+        } else if (arg == "--validation" && i + 1 < argc && parseOnOff(argv[i + 1], m_vulkanContext.m_debug.m_requested)) {
+            ++i;
+        } else {
+            printUsage();
+            return -1;
+        }
+    }
+
+    if (m_vulkanContext.m_debug.m_requested && !VULKAN_DEBUG_BUILD) {
+        std::cerr << "Warning: built without TRIG_VULKAN_DEBUG, --validation on has no effect" << std::endl;
+    }
+
+    if (!exportSettings.m_outputPath.empty()) {
+        exportSettings.m_validation = m_vulkanContext.m_debug.m_requested;
+        exportSettings.m_params = m_appState.m_params;
+        exportSettings.m_phaseSpeed = PHASE_SPEED;
+        exportSettings.m_vertexFormat = m_vulkanContext.m_vertexFormat;
+        exportSettings.m_spectrum = m_appState.m_spectrum.m_enabled;
+        exportSettings.m_spectrumWindow = m_appState.m_spectrum.m_window;
+        return runExport(exportSettings, svgOptions, m_appState.m_spectrum);
+    }
 
-int main() {
     // Initialize GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -12,43 +314,133 @@ int main() {
     }
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    GLFWwindow* m_mainWindow = glfwCreateWindow(800, 600, "Trigonometricly", nullptr, nullptr);
-    if (!m_mainWindow) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-
-    VulkanContext m_vulkanContext;
+    // Same order as m_vulkanContext.m_windows, the first one is the main window
+    std::vector<std::unique_ptr<WindowState>> windows;
+    auto destroyWindows = [&] {
+        for (auto& window : windows) {
+            glfwDestroyWindow(window->m_handle);
+        }
+        windows.clear();
+    };
+    auto openWindow = [&](const std::string& t_title) {
+        auto state = std::make_unique<WindowState>();
+        state->m_app = &m_appState;
+        if (!createWindow(*state, t_title)) {
+            throw std::runtime_error("Failed to create GLFW window");
+        }
+        windows.push_back(std::move(state));
+        return windows.back()->m_handle;
+    };
 
     try {
-        // Initialize Vulkan
-        InitVulkan::initialize(m_mainWindow, m_vulkanContext);
+        // Initialize Vulkan, further windows share the device of the first
+        InitVulkan::initialize(openWindow("Trigonometricly"), m_vulkanContext);
+        for (int i = 1; i < windowCount; ++i) {
+            InitVulkan::addWindow(m_vulkanContext, openWindow("Trigonometricly " + std::to_string(i + 1)));
+        }
+
+        sine::SineParams lastParams;
+        bool lastSpectrum = false;
+        // Packed in the context's vertex format, which is only final after initialize.
+        // Kept between frames: redrawing without regenerating reuses them, regenerating reuses their capacity
+        std::vector<uint8_t> vertexData;
+        std::vector<CurveRange> curves;
+
+        // Main loop, runs until the main window is closed
+        while (!glfwWindowShouldClose(windows.front()->m_handle)) {
+            if (!pacing::waitForNextFrame(m_appState.m_pacer)) {
+                continue;
+            }
+            // Scratch memory of the last frame is free again
+            m_vulkanContext.m_frameArena.reset();
 
-        // Main loop
-        while (!glfwWindowShouldClose(m_mainWindow)) {
-            glfwPollEvents();
+            for (size_t i = windows.size() - 1; i > 0; --i) {
+                if (glfwWindowShouldClose(windows[i]->m_handle)) {
+                    InitVulkan::removeWindow(m_vulkanContext, i);
+                    glfwDestroyWindow(windows[i]->m_handle);
+                    windows.erase(windows.begin() + i);
+                }
+            }
 
-            // Generate sine wave vertices
-            auto sineVertices = sine::generateSineWave(0.5f, 1.0f, static_cast<float>(glfwGetTime()), 200);
+            // Only advance the animation while it's running, so pausing holds the phase
+            timebase::advance(m_appState.m_clock, timebase::wallNow());
+            if (!m_appState.m_clock.m_paused) {
+                pacing::requestRedraw(m_appState.m_pacer);
+            }
 
-            // Draw frame
-            InitVulkan::renderFrame(m_vulkanContext, sineVertices);
+            sine::SineParams params = m_appState.m_params;
+            params.m_phase = timebase::phase(m_appState.m_clock.m_now, PHASE_SPEED);
+            if (params != lastParams || m_appState.m_spectrum.m_enabled != lastSpectrum) {
+                dirty::mark(m_appState.m_tracker, dirty::CURVE_PARAMS);
+                lastParams = params;
+                lastSpectrum = m_appState.m_spectrum.m_enabled;
+            }
+
+            for (size_t i = 0; i < windows.size(); ++i) {
+                WindowContext& target = m_vulkanContext.m_windows[i];
+                // Panning and zooming only changes the push constants, the vertices stay as they are
+                if (windows[i]->m_view != target.m_view) {
+                    dirty::mark(m_appState.m_tracker, dirty::VIEW);
+                    target.m_view = windows[i]->m_view;
+                }
+                if (windows[i]->m_framebufferResized) {
+                    windows[i]->m_framebufferResized = false;
+                    InitVulkan::recreateSwapChain(m_vulkanContext, i);
+                }
+            }
+
+            // Generate sine wave vertices, plus the spectrum when it's shown
+            if (dirty::needsRegeneration(m_appState.m_tracker)) {
+                curves::generate(params, m_appState.m_spectrum, m_vulkanContext.m_vertexFormat, m_vulkanContext.m_frameArena,
+                                 vertexData, curves);
+            }
+
+            // Snapshot of exactly what is on screen in that window, vertices and view included
+            for (size_t i = 0; i < windows.size(); ++i) {
+                if (!windows[i]->m_svgRequested) {
+                    continue;
+                }
+                windows[i]->m_svgRequested = false;
+                svgOptions.m_width = m_vulkanContext.m_windows[i].m_swapChainExtent.width;
+                svgOptions.m_height = m_vulkanContext.m_windows[i].m_swapChainExtent.height;
+                svgOptions.m_view = m_vulkanContext.m_windows[i].m_view;
+                writeSvg("trig_" + std::to_string(m_appState.m_svgCount++) + ".svg", svgOptions,
+                         vertexData, m_vulkanContext.m_vertexFormat, curves);
+            }
+
+            // Nothing changed, the image on screen is still up to date
+            if (!dirty::needsRedraw(m_appState.m_tracker)) {
+                dirty::endFrame(m_appState.m_tracker, false, false);
+                pacing::idle(m_appState.m_pacer);
+                continue;
+            }
+
+            // Every regeneration is uploaded once, redraws reuse the vertex buffer
+            if (dirty::needsRegeneration(m_appState.m_tracker)) {
+                InitVulkan::uploadVertices(m_vulkanContext, vertexData.data(), vertexData.size());
+            }
+
+            // Draw frame into all windows with one submit
+            FrameResult frame = InitVulkan::drawFrame(m_vulkanContext, curves);
+            dirty::endFrame(m_appState.m_tracker, frame.m_submitted, frame.m_retrySwapchain);
         }
 
+        dirty::printCounters(std::cout, m_appState.m_tracker.m_counters);
+        VulkanDebug::printCounters(std::cout, m_vulkanContext.m_debug.m_counters);
+
         // Cleanup Vulkan
         InitVulkan::cleanup(m_vulkanContext);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         InitVulkan::cleanup(m_vulkanContext);
-        glfwDestroyWindow(m_mainWindow);
+        destroyWindows();
         glfwTerminate();
         return -1;
     }
 
     // Cleanup GLFW
-    glfwDestroyWindow(m_mainWindow);
+    destroyWindows();
     glfwTerminate();
 
     return 0;
-}
\ No newline at end of file
+}
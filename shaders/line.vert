@@ -1,5 +1,20 @@
 #version 450
+// Set at pipeline creation for vertex formats that only store y
+layout(constant_id = 0) const bool Y_ONLY = false;
 layout(location = 0) in vec2 inPos;
+// World to clip transform, lets the view pan and zoom without touching the vertices,
+// followed by the per-curve constants that unpack compact vertex formats
+layout(push_constant) uniform Push {
+    vec2 scale;
+    vec2 offset;
+    float xStart;
+    float xStep;
+    float yScale;
+    float yOffset;
+} pc;
 void main() {
-    gl_Position = vec4(inPos, 0.0, 1.0);
+    // samples are evenly spaced, so y-only formats get x back from the index
+    vec2 world = Y_ONLY ? vec2(pc.xStart + float(gl_VertexIndex) * pc.xStep, inPos.x) : inPos;
+    world.y = world.y * pc.yScale + pc.yOffset;
+    gl_Position = vec4(world * pc.scale + pc.offset, 0.0, 1.0);
 }
@@ -0,0 +1,273 @@
+#include "FrameExport.hpp"
+#include "InitVulkan.hpp"
+#include "encode.hpp"
+#include "workers.hpp"
+#include "timebase.hpp"
+#include "curves.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Host visible copy target of one frame slot
+    struct ReadbackSlot {
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        VkDeviceMemory m_memory = VK_NULL_HANDLE;
+        const uint8_t* m_mapped = nullptr;
+        // Frame whose pixels are on their way into m_buffer, -1 when free
+        int64_t m_pendingFrame = -1;
+        // Timeline value its submit signals, the pixels are in once the GPU got there
+        uint64_t m_timelineValue = 0;
+    };
+
+    // Y4M frames are encoded in parallel but have to land in the file in order
+    struct OrderedWriter {
+        std::ofstream m_file;
+        std::mutex m_mutex;
+        std::condition_variable m_turn;
+        uint32_t m_next = 0;
+    };
+
+    void createReadbackSlots(VulkanContext& t_context, uint32_t t_count, VkDeviceSize t_size, std::vector<ReadbackSlot>& t_slots) {
+        t_slots.resize(t_count);
+        for (auto& slot : t_slots) {
+            // cached memory makes the CPU side copy out of the staging buffer much faster, if available
+            try {
+                createBuffer(t_context.m_physicalDevice, t_context.m_device, t_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                             slot.m_buffer, slot.m_memory);
+            } catch (const std::runtime_error&) {
+                vkDestroyBuffer(t_context.m_device, slot.m_buffer, nullptr);
+                slot.m_buffer = VK_NULL_HANDLE;
+                createBuffer(t_context.m_physicalDevice, t_context.m_device, t_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             slot.m_buffer, slot.m_memory);
+            }
+
+            void* mapped = nullptr;
+            VK_CHECK(vkMapMemory(t_context.m_device, slot.m_memory, 0, t_size, 0, &mapped));
+            slot.m_mapped = static_cast<const uint8_t*>(mapped);
+        }
+    }
+
+    void destroyReadbackSlots(VulkanContext& t_context, std::vector<ReadbackSlot>& t_slots) {
+        if (t_context.m_device == VK_NULL_HANDLE) {
+            return;
+        }
+        vkDeviceWaitIdle(t_context.m_device);
+        for (auto& slot : t_slots) {
+            vkDestroyBuffer(t_context.m_device, slot.m_buffer, nullptr);
+            vkFreeMemory(t_context.m_device, slot.m_memory, nullptr);
+        }
+        t_slots.clear();
+    }
+
+    // Render pass into the image of frame slot t_slot, then copy it into the slot's staging buffer
+    void recordExportCommands(VulkanContext& t_context, uint32_t t_slot, Span<const CurveRange> t_curves, VkBuffer t_readback) {
+        WindowContext& target = t_context.m_windows.front();
+        VkCommandBuffer commandBuffer = target.m_commandBuffers[t_slot];
+        VkCommandBufferBeginInfo bi{};
+        bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(commandBuffer, &bi));
+
+        InitVulkan::recordDrawCommands(t_context, target, commandBuffer, t_slot, t_curves);
+
+        // the render pass already left the image in TRANSFER_SRC_OPTIMAL, only the writes need to be made visible
+        VkImageMemoryBarrier toTransfer{};
+        toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        toTransfer.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.image = target.m_swapChainImages[t_slot];
+        toTransfer.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0; // tightly packed
+        region.bufferImageHeight = 0;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {target.m_swapChainExtent.width, target.m_swapChainExtent.height, 1};
+        vkCmdCopyImageToBuffer(commandBuffer, target.m_swapChainImages[t_slot],
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, t_readback, 1, &region);
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = t_readback;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+        VK_CHECK(vkEndCommandBuffer(commandBuffer));
+    }
+
+    std::string pngPath(const std::string& t_directory, uint32_t t_frame) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%05u.png", t_frame);
+        return (std::filesystem::path(t_directory) / name).string();
+    }
+
+    void writeFile(const std::string& t_path, const std::vector<uint8_t>& t_bytes) {
+        std::ofstream file(t_path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open " + t_path);
+        }
+        file.write(reinterpret_cast<const char*>(t_bytes.data()), static_cast<std::streamsize>(t_bytes.size()));
+    }
+
+    // Runs on a writer thread, owns the pixels copied out of the staging buffer
+    void encodeFrame(const FrameExport::Settings& t_settings, OrderedWriter& t_writer, uint32_t t_frame, const std::vector<uint8_t>& t_pixels) {
+        std::vector<uint8_t> encoded;
+        if (t_settings.m_format == FrameExport::Format::PNG) {
+            encode::encodePng(t_pixels.data(), t_settings.m_width, t_settings.m_height, encoded);
+            writeFile(pngPath(t_settings.m_outputPath, t_frame), encoded);
+            return;
+        }
+
+        // the turn has to be passed on even if encoding failed, or later frames would wait forever
+        std::exception_ptr error;
+        try {
+            encode::encodeY4mFrame(t_pixels.data(), t_settings.m_width, t_settings.m_height, encoded);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::unique_lock<std::mutex> lock(t_writer.m_mutex);
+            t_writer.m_turn.wait(lock, [&] { return t_writer.m_next == t_frame; });
+            if (!error) {
+                t_writer.m_file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            }
+            ++t_writer.m_next;
+        }
+        t_writer.m_turn.notify_all();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+FrameExport::Stats FrameExport::run(const Settings& t_settings) {
+    const uint32_t slotCount = std::max(1u, t_settings.m_readbackSlots);
+    const unsigned threadCount = t_settings.m_writerThreads ? t_settings.m_writerThreads
+                                                            : std::max(1u, std::thread::hardware_concurrency());
+    const VkDeviceSize frameBytes = static_cast<VkDeviceSize>(t_settings.m_width) * t_settings.m_height * 4;
+
+    OrderedWriter writer;
+    if (t_settings.m_format == Format::PNG) {
+        std::filesystem::create_directories(t_settings.m_outputPath);
+    } else {
+        writer.m_file.open(t_settings.m_outputPath, std::ios::binary);
+        if (!writer.m_file.is_open()) {
+            throw std::runtime_error("failed to open " + t_settings.m_outputPath);
+        }
+        writer.m_file << encode::y4mHeader(t_settings.m_width, t_settings.m_height, t_settings.m_fps);
+    }
+
+    VulkanContext context;
+    context.m_vertexFormat = t_settings.m_vertexFormat;
+    // one frame slot per readback slot, each with its own image and vertex region
+    context.m_framesInFlight = slotCount;
+    context.m_debug.m_requested = t_settings.m_validation;
+    std::vector<ReadbackSlot> slots;
+    Stats stats;
+
+    try {
+        InitVulkan::initializeHeadless(context, t_settings.m_width, t_settings.m_height);
+        createReadbackSlots(context, slotCount, frameBytes, slots);
+
+        // bounded queue, a slow disk throttles rendering instead of piling up frames in memory
+        WorkerPool pool(threadCount, threadCount * 2);
+
+        auto collect = [&](ReadbackSlot& t_slot) {
+            auto waitStart = Clock::now();
+            InitVulkan::waitForTimeline(context, t_slot.m_timelineValue);
+            auto copyStart = Clock::now();
+            stats.m_gpuWaitSeconds += std::chrono::duration<double>(copyStart - waitStart).count();
+
+            auto pixels = std::make_shared<std::vector<uint8_t>>(t_slot.m_mapped, t_slot.m_mapped + frameBytes);
+            uint32_t frame = static_cast<uint32_t>(t_slot.m_pendingFrame);
+            t_slot.m_pendingFrame = -1;
+
+            auto submitStart = Clock::now();
+            pool.submit([&t_settings, &writer, frame, pixels] { encodeFrame(t_settings, writer, frame, *pixels); });
+            stats.m_writerWaitSeconds += std::chrono::duration<double>(Clock::now() - submitStart).count();
+            ++stats.m_frames;
+        };
+
+        // Every frame slot draws from its own region of the vertex buffer, so uploading
+        // frame n never touches vertices a frame still in flight is reading
+        // the same curves the window draws, the spectrum's scratch memory comes from the context's arena
+        sine::SineParams params = t_settings.m_params;
+        curves::Spectrum spectrum;
+        spectrum.m_enabled = t_settings.m_spectrum;
+        spectrum.m_window = t_settings.m_spectrumWindow;
+        std::vector<uint8_t> vertexData;
+        std::vector<CurveRange> frameCurves;
+        curves::generate(params, spectrum, context.m_vertexFormat, context.m_frameArena, vertexData, frameCurves);
+        // size the regions up front, growing would wait for the whole device
+        InitVulkan::uploadVertices(context, vertexData.data(), vertexData.size());
+
+        auto start = Clock::now();
+        for (uint32_t frame = 0; frame < t_settings.m_frameCount; ++frame) {
+            // the slot's previous frame is read back first, which also means the GPU is done with the slot
+            ReadbackSlot& slot = slots[context.m_currentFrame];
+            if (slot.m_pendingFrame >= 0) {
+                collect(slot);
+            }
+
+            context.m_frameArena.reset();
+            params.m_phase = timebase::phase(timebase::frameTime(frame, t_settings.m_fps), t_settings.m_phaseSpeed);
+            curves::generate(params, spectrum, context.m_vertexFormat, context.m_frameArena, vertexData, frameCurves);
+            InitVulkan::uploadVertices(context, vertexData.data(), vertexData.size());
+
+            uint32_t slotIndex = InitVulkan::beginFrame(context);
+            recordExportCommands(context, slotIndex, frameCurves, slot.m_buffer);
+
+            VkCommandBuffer commandBuffer = context.m_windows.front().m_commandBuffers[slotIndex];
+            slot.m_timelineValue = InitVulkan::submitFrame(context, {&commandBuffer, 1});
+            slot.m_pendingFrame = frame;
+        }
+
+        // collect what is still in flight, oldest first
+        for (uint32_t i = 0; i < slotCount; ++i) {
+            ReadbackSlot& slot = slots[(context.m_currentFrame + i) % slotCount];
+            if (slot.m_pendingFrame >= 0) {
+                collect(slot);
+            }
+        }
+        pool.wait();
+        stats.m_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        destroyReadbackSlots(context, slots);
+        InitVulkan::cleanup(context);
+    } catch (...) {
+        destroyReadbackSlots(context, slots);
+        InitVulkan::cleanup(context);
+        throw;
+    }
+
+    return stats;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "sine.hpp"
+#include "fft.hpp"
+#include "VulkanDebug.hpp"
+
+// Offline rendering of the animated curve straight into image files, no window involved
+namespace FrameExport {
+    enum class Format {
+        PNG, // one file per frame inside the output directory
+        Y4M, // a single YUV4MPEG2 stream
+    };
+
+    struct Settings {
+        std::string m_outputPath;
+        Format m_format = Format::PNG;
+        uint32_t m_width = 800;
+        uint32_t m_height = 600;
+        uint32_t m_frameCount = 120;
+        // Fixed timestep: frame n is rendered at time n / fps
+        uint32_t m_fps = 60;
+        // Radians of phase per second of animation time
+        double m_phaseSpeed = 1.0;
+        // Frames in flight on the GPU while older ones are read back, each owns an image and a staging buffer
+        uint32_t m_readbackSlots = 3;
+        // Threads encoding and writing frames, 0 uses every hardware thread
+        unsigned m_writerThreads = 0;
+        sine::SineParams m_params;
+        VertexFormat m_vertexFormat = VertexFormat::FLOAT2;
+        // Also draw the spectrum curve, as the window does with --spectrum
+        bool m_spectrum = false;
+        fft::Window m_spectrumWindow = fft::Window::HANN;
+        // Run under the validation layer, only in builds with TRIG_VULKAN_DEBUG
+        bool m_validation = VULKAN_DEBUG_BUILD;
+    };
+
+    struct Stats {
+        uint32_t m_frames = 0;
+        double m_seconds = 0.0;
+        // Where the render thread blocked: waiting on readbacks (GPU bound) or on busy writers (encode/disk bound)
+        double m_gpuWaitSeconds = 0.0;
+        double m_writerWaitSeconds = 0.0;
+    };
+
+    Stats run(const Settings& t_settings);
+}
@@ -8,12 +8,6 @@
 #include <algorithm>
 #include <iostream>
 
-#define VK_CHECK(fn)                              \
-    if ((fn) != VK_SUCCESS)                       \
-    {                                             \
-        throw std::runtime_error("Vulkan error"); \
-    }
-
 // helper functions
 static std::vector<char> readFile(const std::string &filename)
 {
@@ -73,6 +67,14 @@ static QueueFamilyIndices findQueueFamilies(VkPhysicalDevice t_dev,
     {
         if (props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
             idx.m_graphicsFamily = i;
+        // without a surface nothing is presented, the graphics queue stands in
+        if (t_surf == VK_NULL_HANDLE)
+        {
+            idx.m_presentFamily = idx.m_graphicsFamily;
+            if (idx.isComplete())
+                break;
+            continue;
+        }
         VkBool32 presentOK = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(t_dev, i, t_surf, &presentOK);
         if (presentOK)
@@ -114,9 +116,18 @@ static SwapChainSupport querySwapChainSupport(VkPhysicalDevice t_dev,
     return sup;
 }
 
+// All windows share one render pass, so once the first window picked a format the others must match it
 static VkSurfaceFormatKHR pickSurfaceFormat(
-    const std::vector<VkSurfaceFormatKHR> &t_avail)
+    const std::vector<VkSurfaceFormatKHR> &t_avail,
+    VkFormat t_required)
 {
+    if (t_required != VK_FORMAT_UNDEFINED)
+    {
+        for (auto &f : t_avail)
+            if (f.format == t_required)
+                return f;
+        throw std::runtime_error("Window surface doesn't support the shared swapchain format");
+    }
     for (auto &f : t_avail)
     {
         if (f.format == VK_FORMAT_B8G8R8A8_SRGB &&
@@ -126,12 +137,19 @@ static VkSurfaceFormatKHR pickSurfaceFormat(
     return t_avail[0];
 }
 
+// FIFO is the only mode every driver must support, so it is the fallback
 static VkPresentModeKHR pickPresentMode(
-    const std::vector<VkPresentModeKHR> &t_avail)
+    const std::vector<VkPresentModeKHR> &t_avail,
+    VkPresentModeKHR t_preferred)
 {
     for (auto &m : t_avail)
-        if (m == VK_PRESENT_MODE_MAILBOX_KHR)
+        if (m == t_preferred)
             return m;
+    // without tearing, MAILBOX is the closest to IMMEDIATE's latency
+    if (t_preferred == VK_PRESENT_MODE_IMMEDIATE_KHR)
+        for (auto &m : t_avail)
+            if (m == VK_PRESENT_MODE_MAILBOX_KHR)
+                return m;
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -159,13 +177,41 @@ static VkExtent2D pickExtent(const VkSurfaceCapabilitiesKHR &t_caps,
     return actual;
 }
 
-static void createBuffer(VkPhysicalDevice t_phys,
-                         VkDevice t_dev,
-                         VkDeviceSize t_size,
-                         VkBufferUsageFlags t_usage,
-                         VkMemoryPropertyFlags t_props,
-                         VkBuffer &t_buffer,
-                         VkDeviceMemory &t_bufferMem)
+static VkFormat vertexInputFormat(VertexFormat t_format)
+{
+    switch (t_format)
+    {
+    case VertexFormat::FLOAT2:
+        return VK_FORMAT_R32G32_SFLOAT;
+    case VertexFormat::HALF2:
+        return VK_FORMAT_R16G16_SFLOAT;
+    case VertexFormat::FLOAT_Y:
+        return VK_FORMAT_R32_SFLOAT;
+    case VertexFormat::HALF_Y:
+        return VK_FORMAT_R16_SFLOAT;
+    case VertexFormat::SNORM16_Y:
+        return VK_FORMAT_R16_SNORM;
+    }
+    return VK_FORMAT_R32G32_SFLOAT;
+}
+
+// 32 bit float formats are always fetchable, the 16 bit ones fall back to their float32 equivalent
+static VertexFormat pickVertexFormat(VkPhysicalDevice t_phys, VertexFormat t_requested)
+{
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(t_phys, vertexInputFormat(t_requested), &props);
+    if (props.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT)
+        return t_requested;
+    return sine::isYOnly(t_requested) ? VertexFormat::FLOAT_Y : VertexFormat::FLOAT2;
+}
+
+void createBuffer(VkPhysicalDevice t_phys,
+                  VkDevice t_dev,
+                  VkDeviceSize t_size,
+                  VkBufferUsageFlags t_usage,
+                  VkMemoryPropertyFlags t_props,
+                  VkBuffer &t_buffer,
+                  VkDeviceMemory &t_bufferMem)
 {
     VkBufferCreateInfo bi{};
     bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -182,7 +228,7 @@ static void createBuffer(VkPhysicalDevice t_phys,
     ai.memoryTypeIndex =
         findMemoryType(t_phys, mr.memoryTypeBits, t_props);
     VK_CHECK(vkAllocateMemory(t_dev, &ai, nullptr, &t_bufferMem));
-    vkBindBufferMemory(t_dev, t_buffer, t_bufferMem, 0);
+    VK_CHECK(vkBindBufferMemory(t_dev, t_buffer, t_bufferMem, 0));
 }
 
 // general Vulkan Declerations
@@ -198,32 +244,46 @@ namespace VulkanHelpers
         appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName = "No Engine";
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion = VK_API_VERSION_1_0;
+        // timeline semaphores are core in 1.2
+        appInfo.apiVersion = VK_API_VERSION_1_2;
 
         VkInstanceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
         createInfo.pApplicationInfo = &appInfo;
 
-        uint32_t glfwExtensionCount = 0;
-        const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-        createInfo.enabledExtensionCount = glfwExtensionCount;
-        createInfo.ppEnabledExtensionNames = glfwExtensions;
+        // headless contexts have no surface and don't need GLFW to be initialized
+        std::vector<const char *> extensions;
+        if (!t_context.m_headless)
+        {
+            uint32_t glfwExtensionCount = 0;
+            const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
-        createInfo.enabledLayerCount = 0;
+        // nothing is added unless validation was built in, requested and is installed
+        std::vector<const char *> layers;
+        VkDebugUtilsMessengerCreateInfoEXT messengerInfo{};
+        VulkanDebug::addInstanceRequirements(t_context.m_debug, layers, extensions, messengerInfo);
+        if (t_context.m_debug.m_enabled)
+            createInfo.pNext = &messengerInfo;
 
-        if (vkCreateInstance(&createInfo, nullptr, &t_context.m_instance) != VK_SUCCESS)
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
+        createInfo.enabledLayerCount = static_cast<uint32_t>(layers.size());
+        createInfo.ppEnabledLayerNames = layers.data();
+
+        VkResult result = vkCreateInstance(&createInfo, nullptr, &t_context.m_instance);
+        if (result != VK_SUCCESS)
         {
-            throw std::runtime_error("Failed to create Vulkan instance");
+            throw VulkanError(result, "vkCreateInstance", __FILE__, __LINE__);
         }
+        VulkanDebug::createMessenger(t_context.m_debug, t_context.m_instance);
     }
 
     // Create Vulkan surface
-    void createSurface(GLFWwindow *t_window, VulkanContext &t_context)
+    void createSurface(VulkanContext &t_context, WindowContext &t_window)
     {
-        if (glfwCreateWindowSurface(t_context.m_instance, t_window, nullptr, &t_context.m_surface) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create window surface");
-        }
+        VK_CHECK(glfwCreateWindowSurface(t_context.m_instance, t_window.m_window, nullptr, &t_window.m_surface));
     }
 
     // Pick physical device
@@ -239,9 +299,21 @@ namespace VulkanHelpers
         std::vector<VkPhysicalDevice> devices(deviceCount);
         vkEnumeratePhysicalDevices(t_context.m_instance, &deviceCount, devices.data());
 
+        // frame slots are tracked with a timeline semaphore
         for (const auto &device : devices)
         {
-            if (true /* Add device suitability checks here */)
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(device, &props);
+            if (props.apiVersion < VK_API_VERSION_1_2)
+                continue;
+
+            VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+            timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &timelineFeatures;
+            vkGetPhysicalDeviceFeatures2(device, &features);
+            if (timelineFeatures.timelineSemaphore)
             {
                 t_context.m_physicalDevice = device;
                 break;
@@ -254,10 +326,12 @@ namespace VulkanHelpers
         }
     }
 
-    // Create logical device
-    void createLogicalDevice(VulkanContext &t_context)
+    // Create logical device, the present queue is picked for t_surface
+    void createLogicalDevice(VulkanContext &t_context, VkSurfaceKHR t_surface)
     {
-        QueueFamilyIndices indices = findQueueFamilies(t_context.m_physicalDevice, t_context.m_surface);
+        QueueFamilyIndices indices = findQueueFamilies(t_context.m_physicalDevice, t_surface);
+        t_context.m_graphicsQueueFamily = indices.m_graphicsFamily.value();
+        t_context.m_presentQueueFamily = indices.m_presentFamily.value();
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = {indices.m_graphicsFamily.value(), indices.m_presentFamily.value()};
@@ -274,9 +348,13 @@ namespace VulkanHelpers
         }
 
         VkPhysicalDeviceFeatures deviceFeatures{};
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+        timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+        timelineFeatures.timelineSemaphore = VK_TRUE;
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = &timelineFeatures;
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
         createInfo.pEnabledFeatures = &deviceFeatures;
@@ -284,23 +362,20 @@ namespace VulkanHelpers
         createInfo.enabledExtensionCount = static_cast<uint32_t>(t_context.m_deviceExtensions.size());
         createInfo.ppEnabledExtensionNames = t_context.m_deviceExtensions.data();
 
-        if (vkCreateDevice(t_context.m_physicalDevice, &createInfo, nullptr, &t_context.m_device) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create logical device!");
-        }
+        VK_CHECK(vkCreateDevice(t_context.m_physicalDevice, &createInfo, nullptr, &t_context.m_device));
 
         vkGetDeviceQueue(t_context.m_device, indices.m_graphicsFamily.value(), 0, &t_context.m_graphicsQueue);
         vkGetDeviceQueue(t_context.m_device, indices.m_presentFamily.value(), 0, &t_context.m_presentQueue);
     }
 
     // Create swap chain
-    void createSwapChain(VulkanContext &t_context)
+    void createSwapChain(VulkanContext &t_context, WindowContext &t_window)
     {
-        SwapChainSupport swapChainSupport = querySwapChainSupport(t_context.m_physicalDevice, t_context.m_surface);
+        SwapChainSupport swapChainSupport = querySwapChainSupport(t_context.m_physicalDevice, t_window.m_surface);
 
-        VkSurfaceFormatKHR surfaceFormat = pickSurfaceFormat(swapChainSupport.m_formats);
-        VkPresentModeKHR presentMode = pickPresentMode(swapChainSupport.m_presentModes);
-        VkExtent2D extent = pickExtent(swapChainSupport.m_caps, t_context.m_window);
+        VkSurfaceFormatKHR surfaceFormat = pickSurfaceFormat(swapChainSupport.m_formats, t_context.m_swapChainImageFormat);
+        VkPresentModeKHR presentMode = pickPresentMode(swapChainSupport.m_presentModes, t_context.m_preferredPresentMode);
+        VkExtent2D extent = pickExtent(swapChainSupport.m_caps, t_window.m_window);
 
         uint32_t imageCount = swapChainSupport.m_caps.minImageCount + 1;
         if (swapChainSupport.m_caps.maxImageCount > 0 && imageCount > swapChainSupport.m_caps.maxImageCount)
@@ -310,7 +385,7 @@ namespace VulkanHelpers
 
         VkSwapchainCreateInfoKHR createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-        createInfo.surface = t_context.m_surface;
+        createInfo.surface = t_window.m_surface;
 
         createInfo.minImageCount = imageCount;
         createInfo.imageFormat = surfaceFormat.format;
@@ -319,10 +394,9 @@ namespace VulkanHelpers
         createInfo.imageArrayLayers = 1;
         createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
-        QueueFamilyIndices indices = findQueueFamilies(t_context.m_physicalDevice, t_context.m_surface);
-        uint32_t queueFamilyIndices[] = {indices.m_graphicsFamily.value(), indices.m_presentFamily.value()};
+        uint32_t queueFamilyIndices[] = {t_context.m_graphicsQueueFamily, t_context.m_presentQueueFamily};
 
-        if (indices.m_graphicsFamily != indices.m_presentFamily)
+        if (t_context.m_graphicsQueueFamily != t_context.m_presentQueueFamily)
         {
             createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
             createInfo.queueFamilyIndexCount = 2;
@@ -338,29 +412,72 @@ namespace VulkanHelpers
         createInfo.presentMode = presentMode;
         createInfo.clipped = VK_TRUE;
 
-        if (vkCreateSwapchainKHR(t_context.m_device, &createInfo, nullptr, &t_context.m_swapChain) != VK_SUCCESS)
+        VkResult result = vkCreateSwapchainKHR(t_context.m_device, &createInfo, nullptr, &t_window.m_swapChain);
+        if (result != VK_SUCCESS)
         {
-            throw std::runtime_error("Failed to create swap chain!");
+            throw VulkanError(result, "vkCreateSwapchainKHR", __FILE__, __LINE__);
         }
+        VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_SWAPCHAIN_KHR, t_window.m_swapChain, "swapchain");
 
-        vkGetSwapchainImagesKHR(t_context.m_device, t_context.m_swapChain, &imageCount, nullptr);
-        t_context.m_swapChainImages.resize(imageCount);
-        vkGetSwapchainImagesKHR(t_context.m_device, t_context.m_swapChain, &imageCount, t_context.m_swapChainImages.data());
+        vkGetSwapchainImagesKHR(t_context.m_device, t_window.m_swapChain, &imageCount, nullptr);
+        t_window.m_swapChainImages.resize(imageCount);
+        vkGetSwapchainImagesKHR(t_context.m_device, t_window.m_swapChain, &imageCount, t_window.m_swapChainImages.data());
 
         t_context.m_swapChainImageFormat = surfaceFormat.format;
-        t_context.m_swapChainExtent = extent;
+        t_window.m_swapChainExtent = extent;
+        t_window.m_presentMode = presentMode;
+    }
+
+    // Create offscreen color targets standing in for swapchain images
+    void createOffscreenImages(VulkanContext &t_context, WindowContext &t_window, uint32_t t_width, uint32_t t_height, uint32_t t_imageCount)
+    {
+        // sRGB like the window's swapchain, so exported frames have the same colors. RGBA order
+        // keeps the readback in the byte order the encoders expect
+        t_context.m_swapChainImageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+        t_window.m_swapChainExtent = {t_width, t_height};
+        t_window.m_swapChainImages.resize(t_imageCount);
+        t_window.m_offscreenImageMemory.resize(t_imageCount);
+
+        for (size_t i = 0; i < t_imageCount; i++)
+        {
+            VkImageCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            createInfo.imageType = VK_IMAGE_TYPE_2D;
+            createInfo.format = t_context.m_swapChainImageFormat;
+            createInfo.extent = {t_width, t_height, 1};
+            createInfo.mipLevels = 1;
+            createInfo.arrayLayers = 1;
+            createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            createInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            VK_CHECK(vkCreateImage(t_context.m_device, &createInfo, nullptr, &t_window.m_swapChainImages[i]));
+
+            VkMemoryRequirements mr;
+            vkGetImageMemoryRequirements(t_context.m_device, t_window.m_swapChainImages[i], &mr);
+            VkMemoryAllocateInfo ai{};
+            ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize = mr.size;
+            ai.memoryTypeIndex =
+                findMemoryType(t_context.m_physicalDevice, mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            VK_CHECK(vkAllocateMemory(t_context.m_device, &ai, nullptr, &t_window.m_offscreenImageMemory[i]));
+            VK_CHECK(vkBindImageMemory(t_context.m_device, t_window.m_swapChainImages[i], t_window.m_offscreenImageMemory[i], 0));
+            VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_IMAGE, t_window.m_swapChainImages[i], "offscreen image");
+        }
     }
 
     // Create image views
-    void createImageViews(VulkanContext &t_context)
+    void createImageViews(VulkanContext &t_context, WindowContext &t_window)
     {
-        t_context.m_swapChainImageViews.resize(t_context.m_swapChainImages.size());
+        t_window.m_swapChainImageViews.resize(t_window.m_swapChainImages.size());
 
-        for (size_t i = 0; i < t_context.m_swapChainImages.size(); i++)
+        for (size_t i = 0; i < t_window.m_swapChainImages.size(); i++)
         {
             VkImageViewCreateInfo createInfo{};
             createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            createInfo.image = t_context.m_swapChainImages[i];
+            createInfo.image = t_window.m_swapChainImages[i];
             createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
             createInfo.format = t_context.m_swapChainImageFormat;
 
@@ -375,10 +492,7 @@ namespace VulkanHelpers
             createInfo.subresourceRange.baseArrayLayer = 0;
             createInfo.subresourceRange.layerCount = 1;
 
-            if (vkCreateImageView(t_context.m_device, &createInfo, nullptr, &t_context.m_swapChainImageViews[i]) != VK_SUCCESS)
-            {
-                throw std::runtime_error("Failed to create image views!");
-            }
+            VK_CHECK(vkCreateImageView(t_context.m_device, &createInfo, nullptr, &t_window.m_swapChainImageViews[i]));
         }
     }
 
@@ -393,7 +507,9 @@ namespace VulkanHelpers
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        // offscreen images are left ready to be copied back to the host
+        colorAttachment.finalLayout = t_context.m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                                           : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentReference colorAttachmentRef{};
         colorAttachmentRef.attachment = 0;
@@ -411,10 +527,8 @@ namespace VulkanHelpers
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
 
-        if (vkCreateRenderPass(t_context.m_device, &renderPassInfo, nullptr, &t_context.m_renderPass) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create render pass!");
-        }
+        VK_CHECK(vkCreateRenderPass(t_context.m_device, &renderPassInfo, nullptr, &t_context.m_renderPass));
+        VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_RENDER_PASS, t_context.m_renderPass, "line render pass");
     }
 
     // Create graphics pipeline
@@ -425,14 +539,15 @@ namespace VulkanHelpers
 
         VkVertexInputBindingDescription bindingDescription{};
         bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
+        bindingDescription.stride = static_cast<uint32_t>(sine::vertexStride(t_context.m_vertexFormat));
         bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
+        // y-only formats fill inPos.x, the missing components read as 0
         VkVertexInputAttributeDescription attributeDescription{};
         attributeDescription.binding = 0;
         attributeDescription.location = 0;
-        attributeDescription.format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescription.offset = offsetof(Vertex, position);
+        attributeDescription.format = vertexInputFormat(t_context.m_vertexFormat);
+        attributeDescription.offset = 0;
 
         vertexInputInfo.vertexBindingDescriptionCount = 1;
         vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
@@ -444,24 +559,17 @@ namespace VulkanHelpers
         inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
         inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<float>(t_context.m_swapChainExtent.width);
-        viewport.height = static_cast<float>(t_context.m_swapChainExtent.height);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = t_context.m_swapChainExtent;
-
+        // viewport and scissor are set while recording, so a resize doesn't need a new pipeline
         VkPipelineViewportStateCreateInfo viewportState{};
         viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
         viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
+
+        VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = 2;
+        dynamicState.pDynamicStates = dynamicStates;
 
         VkPipelineRasterizationStateCreateInfo rasterizer{};
         rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -493,17 +601,19 @@ namespace VulkanHelpers
         colorBlending.blendConstants[2] = 0.0f;
         colorBlending.blendConstants[3] = 0.0f;
 
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(LinePushConstants);
+
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = 0;
         pipelineLayoutInfo.pSetLayouts = nullptr;
-        pipelineLayoutInfo.pushConstantRangeCount = 0;
-        pipelineLayoutInfo.pPushConstantRanges = nullptr;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-        if (vkCreatePipelineLayout(t_context.m_device, &pipelineLayoutInfo, nullptr, &t_context.m_pipelineLayout) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create pipeline layout!");
-        }
+        VK_CHECK(vkCreatePipelineLayout(t_context.m_device, &pipelineLayoutInfo, nullptr, &t_context.m_pipelineLayout));
 
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -515,102 +625,181 @@ namespace VulkanHelpers
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
         pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
         pipelineInfo.layout = t_context.m_pipelineLayout;
         pipelineInfo.renderPass = t_context.m_renderPass;
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(t_context.m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &t_context.m_graphicsPipeline) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create graphics pipeline!");
-        }
+        VK_CHECK(vkCreateGraphicsPipelines(t_context.m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &t_context.m_graphicsPipeline));
+        VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_PIPELINE_LAYOUT, t_context.m_pipelineLayout, "line pipeline layout");
+        VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_PIPELINE, t_context.m_graphicsPipeline, "line pipeline");
     }
 
-    void createFramebuffers(VulkanContext &t_context)
+    void createFramebuffers(VulkanContext &t_context, WindowContext &t_window)
     {
-        t_context.m_swapChainFramebuffers.resize(t_context.m_swapChainImageViews.size());
+        t_window.m_swapChainFramebuffers.resize(t_window.m_swapChainImageViews.size());
 
-        for (size_t i = 0; i < t_context.m_swapChainImageViews.size(); i++)
+        for (size_t i = 0; i < t_window.m_swapChainImageViews.size(); i++)
         {
             VkImageView attachments[] = {
-                t_context.m_swapChainImageViews[i]};
+                t_window.m_swapChainImageViews[i]};
 
             VkFramebufferCreateInfo framebufferInfo{};
             framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
             framebufferInfo.renderPass = t_context.m_renderPass;
             framebufferInfo.attachmentCount = 1;
             framebufferInfo.pAttachments = attachments;
-            framebufferInfo.width = t_context.m_swapChainExtent.width;
-            framebufferInfo.height = t_context.m_swapChainExtent.height;
+            framebufferInfo.width = t_window.m_swapChainExtent.width;
+            framebufferInfo.height = t_window.m_swapChainExtent.height;
             framebufferInfo.layers = 1;
 
-            if (vkCreateFramebuffer(t_context.m_device, &framebufferInfo, nullptr, &t_context.m_swapChainFramebuffers[i]) != VK_SUCCESS)
-            {
-                throw std::runtime_error("Failed to create framebuffer!");
-            }
+            VK_CHECK(vkCreateFramebuffer(t_context.m_device, &framebufferInfo, nullptr, &t_window.m_swapChainFramebuffers[i]));
         }
     }
 
-    void createCommandPool(VulkanContext &t_context)
+    // Every frame slot gets its own command pool, the timeline semaphore tracks them all
+    void createFrameSlots(VulkanContext &t_context)
     {
-        QueueFamilyIndices queueFamilyIndices = findQueueFamilies(t_context.m_physicalDevice, t_context.m_surface);
+        t_context.m_framesInFlight = std::max<uint32_t>(t_context.m_framesInFlight, 1);
+        t_context.m_frames.resize(t_context.m_framesInFlight);
+        t_context.m_currentFrame = 0;
+
+        for (auto &slot : t_context.m_frames)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = t_context.m_graphicsQueueFamily;
+            // re-recorded every time the slot comes around, the pool is reset as a whole
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            VK_CHECK(vkCreateCommandPool(t_context.m_device, &poolInfo, nullptr, &slot.m_commandPool));
+            VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_COMMAND_POOL, slot.m_commandPool, "frame slot command pool");
+        }
 
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = queueFamilyIndices.m_graphicsFamily.value();
-        poolInfo.flags = 0;
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+
+        VK_CHECK(vkCreateSemaphore(t_context.m_device, &semaphoreInfo, nullptr, &t_context.m_timeline));
+        VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_SEMAPHORE, t_context.m_timeline, "frame timeline");
+        t_context.m_timelineValue = 0;
+    }
 
-        if (vkCreateCommandPool(t_context.m_device, &poolInfo, nullptr, &t_context.m_commandPool) != VK_SUCCESS)
+    // One command buffer per frame slot, from that slot's pool
+    void createCommandBuffers(VulkanContext &t_context, WindowContext &t_window)
+    {
+        t_window.m_commandBuffers.resize(t_context.m_frames.size());
+
+        for (size_t i = 0; i < t_context.m_frames.size(); i++)
         {
-            throw std::runtime_error("Failed to create command pool!");
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = t_context.m_frames[i].m_commandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+
+            VK_CHECK(vkAllocateCommandBuffers(t_context.m_device, &allocInfo, &t_window.m_commandBuffers[i]));
         }
     }
 
-    void createCommandBuffers(VulkanContext &t_context)
+    // Acquires are per frame slot: a slot's semaphore is free again once its previous submit finished
+    void createWindowSyncObjects(VulkanContext &t_context, WindowContext &t_window)
     {
-        t_context.m_commandBuffers.resize(t_context.m_swapChainFramebuffers.size());
+        t_window.m_imageAvailableSemaphores.resize(t_context.m_frames.size());
 
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.commandPool = t_context.m_commandPool;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandBufferCount = (uint32_t)t_context.m_commandBuffers.size();
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        if (vkAllocateCommandBuffers(t_context.m_device, &allocInfo, t_context.m_commandBuffers.data()) != VK_SUCCESS)
+        for (auto &semaphore : t_window.m_imageAvailableSemaphores)
         {
-            throw std::runtime_error("Failed to allocate command buffers!");
+            VK_CHECK(vkCreateSemaphore(t_context.m_device, &semaphoreInfo, nullptr, &semaphore));
         }
     }
 
-    void createSyncObjects(VulkanContext &t_context)
+    // Presents are per image: nothing tells when a present stopped waiting, but once its image
+    // is acquired again the semaphore can be signaled anew
+    void createImageSyncObjects(VulkanContext &t_context, WindowContext &t_window)
     {
-        t_context.m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        t_context.m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        t_context.m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+        t_window.m_renderFinishedSemaphores.resize(t_window.m_swapChainImages.size());
 
         VkSemaphoreCreateInfo semaphoreInfo{};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        for (auto &semaphore : t_window.m_renderFinishedSemaphores)
         {
-            if (vkCreateSemaphore(t_context.m_device, &semaphoreInfo, nullptr, &t_context.m_imageAvailableSemaphores[i]) != VK_SUCCESS ||
-                vkCreateSemaphore(t_context.m_device, &semaphoreInfo, nullptr, &t_context.m_renderFinishedSemaphores[i]) != VK_SUCCESS ||
-                vkCreateFence(t_context.m_device, &fenceInfo, nullptr, &t_context.m_inFlightFences[i]) != VK_SUCCESS)
-            {
-                throw std::runtime_error("Failed to create synchronization objects for a frame!");
-            }
+            VK_CHECK(vkCreateSemaphore(t_context.m_device, &semaphoreInfo, nullptr, &semaphore));
         }
     }
 
-    void createVertexBuffer(VulkanContext &t_context)
+    // One region of t_regionSize bytes per frame slot
+    void createVertexBuffer(VulkanContext &t_context, VkDeviceSize t_regionSize)
     {
-        VkDeviceSize bufferSize = sizeof(Vertex) * 200; // Example size
-
+        // keeps every region's start aligned for all vertex formats
+        t_regionSize = (t_regionSize + 15) & ~VkDeviceSize(15);
+        VkDeviceSize bufferSize = t_regionSize * t_context.m_frames.size();
         createBuffer(t_context.m_physicalDevice, t_context.m_device, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, t_context.m_vertexBuffer, t_context.m_vertexBufferMemory);
+        t_context.m_vertexBufferSize = bufferSize;
+        t_context.m_vertexRegionSize = t_regionSize;
+        VulkanDebug::setObjectName(t_context.m_debug, t_context.m_device, VK_OBJECT_TYPE_BUFFER, t_context.m_vertexBuffer, "vertex regions");
+    }
+
+    // Destroy everything that depends on the swapchain images
+    void cleanupSwapChain(VulkanContext &t_context, WindowContext &t_window)
+    {
+        for (auto &fb : t_window.m_swapChainFramebuffers)
+            vkDestroyFramebuffer(t_context.m_device, fb, nullptr);
+        t_window.m_swapChainFramebuffers.clear();
+
+        for (auto &s : t_window.m_renderFinishedSemaphores)
+            vkDestroySemaphore(t_context.m_device, s, nullptr);
+        t_window.m_renderFinishedSemaphores.clear();
+
+        for (auto &iv : t_window.m_swapChainImageViews)
+            vkDestroyImageView(t_context.m_device, iv, nullptr);
+        t_window.m_swapChainImageViews.clear();
+
+        // headless contexts never enable VK_KHR_swapchain, so its commands can't be called there
+        if (!t_context.m_headless && t_window.m_swapChain != VK_NULL_HANDLE)
+            vkDestroySwapchainKHR(t_context.m_device, t_window.m_swapChain, nullptr);
+        t_window.m_swapChain = VK_NULL_HANDLE;
+    }
+
+    // Destroy everything a window owns, the device must be idle
+    void destroyWindow(VulkanContext &t_context, WindowContext &t_window)
+    {
+        if (t_context.m_device != VK_NULL_HANDLE)
+        {
+            cleanupSwapChain(t_context, t_window);
+
+            for (size_t i = 0; i < t_window.m_commandBuffers.size(); i++)
+                vkFreeCommandBuffers(t_context.m_device, t_context.m_frames[i].m_commandPool, 1, &t_window.m_commandBuffers[i]);
+            t_window.m_commandBuffers.clear();
+
+            for (auto &s : t_window.m_imageAvailableSemaphores)
+                vkDestroySemaphore(t_context.m_device, s, nullptr);
+            t_window.m_imageAvailableSemaphores.clear();
+
+            // offscreen images are owned by us, swapchain images by the swapchain
+            if (t_context.m_headless)
+            {
+                for (auto &img : t_window.m_swapChainImages)
+                    vkDestroyImage(t_context.m_device, img, nullptr);
+                for (auto &mem : t_window.m_offscreenImageMemory)
+                    vkFreeMemory(t_context.m_device, mem, nullptr);
+            }
+            t_window.m_swapChainImages.clear();
+            t_window.m_offscreenImageMemory.clear();
+        }
+
+        // likewise for the surface extensions, and a failed vkCreateInstance leaves no instance to destroy it with
+        if (!t_context.m_headless && t_window.m_surface != VK_NULL_HANDLE && t_context.m_instance != VK_NULL_HANDLE)
+            vkDestroySurfaceKHR(t_context.m_instance, t_window.m_surface, nullptr);
+        t_window.m_surface = VK_NULL_HANDLE;
     }
 
 } // namespace VulkanHelpers
@@ -624,10 +813,7 @@ VkShaderModule createShaderModule(const std::vector<char> &t_code, VkDevice t_de
     createInfo.pCode = reinterpret_cast<const uint32_t *>(t_code.data());
 
     VkShaderModule shaderModule;
-    if (vkCreateShaderModule(t_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create shader module");
-    }
+    VK_CHECK(vkCreateShaderModule(t_device, &createInfo, nullptr, &shaderModule));
 
     return shaderModule;
 }
@@ -635,21 +821,9 @@ VkShaderModule createShaderModule(const std::vector<char> &t_code, VkDevice t_de
 // Initialize Vulkan
 namespace InitVulkan
 {
-    void initialize(GLFWwindow *t_window, VulkanContext &t_context)
+    // Everything shared by all windows, needs the swapchain format the first window picked
+    static void createDeviceResources(VulkanContext &t_context)
     {
-        if (t_window == nullptr)
-        {
-            throw std::runtime_error("GLFW window is null. Ensure the window is created before initializing Vulkan.");
-        }
-
-        t_context.m_window = t_window;
-
-        VulkanHelpers::createInstance(t_context);
-        VulkanHelpers::createSurface(t_window, t_context);
-        VulkanHelpers::pickPhysicalDevice(t_context);
-        VulkanHelpers::createLogicalDevice(t_context);
-        VulkanHelpers::createSwapChain(t_context);
-        VulkanHelpers::createImageViews(t_context);
         VulkanHelpers::createRenderPass(t_context);
 
         // Load shaders
@@ -660,11 +834,25 @@ namespace InitVulkan
         VkShaderModule fragShaderModule = createShaderModule(fragShaderCode, t_context.m_device);
 
         // Update pipeline creation to use shaders
+        // line.vert derives x from the vertex index when the format has no x
+        t_context.m_vertexFormat = pickVertexFormat(t_context.m_physicalDevice, t_context.m_vertexFormat);
+        VkBool32 yOnly = sine::isYOnly(t_context.m_vertexFormat) ? VK_TRUE : VK_FALSE;
+        VkSpecializationMapEntry yOnlyEntry{};
+        yOnlyEntry.constantID = 0;
+        yOnlyEntry.offset = 0;
+        yOnlyEntry.size = sizeof(VkBool32);
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = 1;
+        specializationInfo.pMapEntries = &yOnlyEntry;
+        specializationInfo.dataSize = sizeof(VkBool32);
+        specializationInfo.pData = &yOnly;
+
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
         vertShaderStageInfo.module = vertShaderModule;
         vertShaderStageInfo.pName = "main";
+        vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
 
         VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
         fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -681,141 +869,492 @@ namespace InitVulkan
         vkDestroyShaderModule(t_context.m_device, vertShaderModule, nullptr);
         vkDestroyShaderModule(t_context.m_device, fragShaderModule, nullptr);
 
-        VulkanHelpers::createGraphicsPipeline(t_context, shaderStages);
-        VulkanHelpers::createFramebuffers(t_context);
-        VulkanHelpers::createCommandPool(t_context);
-        VulkanHelpers::createCommandBuffers(t_context);
-        VulkanHelpers::createSyncObjects(t_context);
-        VulkanHelpers::createVertexBuffer(t_context);
+        VulkanHelpers::createFrameSlots(t_context);
+        VulkanHelpers::createVertexBuffer(t_context, sizeof(Vertex) * INITIAL_VERTEX_CAPACITY);
     }
 
-    void renderFrame(VulkanContext &t_context, const std::vector<Vertex> &t_vertices)
+    // Everything that comes after a window's swapchain (or the offscreen images)
+    static void createWindowResources(VulkanContext &t_context, WindowContext &t_window)
     {
-        vkWaitForFences(t_context.m_device, 1,
-                        &t_context.m_inFlightFences[t_context.m_currentFrame],
-                        VK_TRUE,
-                        UINT64_MAX);
+        VulkanHelpers::createImageViews(t_context, t_window);
+        VulkanHelpers::createFramebuffers(t_context, t_window);
+        VulkanHelpers::createImageSyncObjects(t_context, t_window);
+        VulkanHelpers::createCommandBuffers(t_context, t_window);
+        VulkanHelpers::createWindowSyncObjects(t_context, t_window);
+    }
 
-        uint32_t imageIndex;
-        vkAcquireNextImageKHR(
-            t_context.m_device,
-            t_context.m_swapChain,
-            UINT64_MAX,
-            t_context.m_imageAvailableSemaphores[t_context.m_currentFrame],
-            VK_NULL_HANDLE,
-            &imageIndex);
+    void initialize(GLFWwindow *t_window, VulkanContext &t_context)
+    {
+        if (t_window == nullptr)
+        {
+            throw std::runtime_error("GLFW window is null. Ensure the window is created before initializing Vulkan.");
+        }
+
+        t_context.m_windows.emplace_back();
+        WindowContext &window = t_context.m_windows.back();
+        window.m_window = t_window;
+
+        VulkanHelpers::createInstance(t_context);
+        VulkanHelpers::createSurface(t_context, window);
+        VulkanHelpers::pickPhysicalDevice(t_context);
+        VulkanHelpers::createLogicalDevice(t_context, window.m_surface);
+        VulkanHelpers::createSwapChain(t_context, window);
+        createDeviceResources(t_context);
+        createWindowResources(t_context, window);
+    }
+
+    size_t addWindow(VulkanContext &t_context, GLFWwindow *t_window)
+    {
+        if (t_window == nullptr)
+        {
+            throw std::runtime_error("GLFW window is null. Ensure the window is created before adding it.");
+        }
+
+        WindowContext window;
+        window.m_window = t_window;
+        try
+        {
+            VulkanHelpers::createSurface(t_context, window);
+            // the queues were picked for the first window's surface
+            VkBool32 presentOK = VK_FALSE;
+            vkGetPhysicalDeviceSurfaceSupportKHR(t_context.m_physicalDevice, t_context.m_presentQueueFamily,
+                                                 window.m_surface, &presentOK);
+            if (!presentOK)
+            {
+                throw std::runtime_error("Window surface can't be presented from the shared present queue");
+            }
+            VulkanHelpers::createSwapChain(t_context, window);
+            createWindowResources(t_context, window);
+        }
+        catch (...)
+        {
+            VulkanHelpers::destroyWindow(t_context, window);
+            throw;
+        }
+
+        t_context.m_windows.push_back(std::move(window));
+        return t_context.m_windows.size() - 1;
+    }
+
+    void removeWindow(VulkanContext &t_context, size_t t_windowIndex)
+    {
+        vkDeviceWaitIdle(t_context.m_device);
+        VulkanHelpers::destroyWindow(t_context, t_context.m_windows[t_windowIndex]);
+        t_context.m_windows.erase(t_context.m_windows.begin() + t_windowIndex);
+    }
+
+    void initializeHeadless(VulkanContext &t_context, uint32_t t_width, uint32_t t_height)
+    {
+        // drawFrame picks the image by frame slot
+        t_context.m_framesInFlight = std::max<uint32_t>(t_context.m_framesInFlight, 1);
+        t_context.m_headless = true;
+        // nothing is presented, so the swapchain extension isn't needed
+        t_context.m_deviceExtensions.clear();
+
+        t_context.m_windows.emplace_back();
+        WindowContext &window = t_context.m_windows.back();
+
+        VulkanHelpers::createInstance(t_context);
+        VulkanHelpers::pickPhysicalDevice(t_context);
+        VulkanHelpers::createLogicalDevice(t_context, VK_NULL_HANDLE);
+        VulkanHelpers::createOffscreenImages(t_context, window, t_width, t_height, t_context.m_framesInFlight);
+        createDeviceResources(t_context);
+        createWindowResources(t_context, window);
+    }
+
+    void uploadVertices(VulkanContext &t_context, const std::vector<Vertex> &t_vertices)
+    {
+        if (t_context.m_vertexFormat != VertexFormat::FLOAT2)
+        {
+            throw std::runtime_error("Vertex data doesn't match the vertex format of the pipeline");
+        }
+        uploadVertices(t_context, t_vertices.data(), t_vertices.size() * sizeof(Vertex));
+    }
+
+    void uploadVertices(VulkanContext &t_context, const void *t_data, VkDeviceSize t_size)
+    {
+        VkDeviceSize size = t_size;
+        if (size == 0)
+            return;
+
+        const size_t region = t_context.m_currentFrame;
+        // grow geometrically so slowly increasing point counts don't reallocate every frame
+        if (size > t_context.m_vertexRegionSize)
+        {
+            vkDeviceWaitIdle(t_context.m_device);
+            vkDestroyBuffer(t_context.m_device, t_context.m_vertexBuffer, nullptr);
+            vkFreeMemory(t_context.m_device, t_context.m_vertexBufferMemory, nullptr);
+            VulkanHelpers::createVertexBuffer(t_context, std::max(size, t_context.m_vertexRegionSize * 2));
+        }
+        else
+        {
+            // only frames that drew from this slot's region have to be done, not every frame in flight
+            waitForTimeline(t_context, t_context.m_frames[region].m_vertexReadValue);
+        }
 
-        // update vertex buffer
         void *data;
-        vkMapMemory(t_context.m_device,
-                    t_context.m_vertexBufferMemory,
-                    0,
-                    t_vertices.size() * sizeof(Vertex),
-                    0,
-                    &data);
-        memcpy(data, t_vertices.data(),
-               t_vertices.size() * sizeof(Vertex));
+        VK_CHECK(vkMapMemory(t_context.m_device,
+                             t_context.m_vertexBufferMemory,
+                             region * t_context.m_vertexRegionSize,
+                             size,
+                             0,
+                             &data));
+        memcpy(data, t_data, size);
         vkUnmapMemory(t_context.m_device, t_context.m_vertexBufferMemory);
+        t_context.m_vertexRegion = region;
+    }
+
+    uint32_t beginFrame(VulkanContext &t_context)
+    {
+        FrameSlot &slot = t_context.m_frames[t_context.m_currentFrame];
+        waitForTimeline(t_context, slot.m_submitValue);
+        VK_CHECK(vkResetCommandPool(t_context.m_device, slot.m_commandPool, 0));
+        return static_cast<uint32_t>(t_context.m_currentFrame);
+    }
+
+    uint64_t submitFrame(VulkanContext &t_context, Span<const VkCommandBuffer> t_commandBuffers,
+                         Span<const VkSemaphore> t_waitSemaphores, Span<const VkPipelineStageFlags> t_waitStages,
+                         Span<const VkSemaphore> t_signalSemaphores)
+    {
+        ArenaScope scratch(t_context.m_frameArena);
+        const uint64_t value = t_context.m_timelineValue + 1;
+
+        // the timeline goes last, the values of binary semaphores are ignored
+        Span<VkSemaphore> signalSemaphores = t_context.m_frameArena.allocate<VkSemaphore>(t_signalSemaphores.size() + 1);
+        std::copy(t_signalSemaphores.begin(), t_signalSemaphores.end(), signalSemaphores.begin());
+        signalSemaphores.back() = t_context.m_timeline;
+        Span<uint64_t> signalValues = t_context.m_frameArena.allocate<uint64_t>(signalSemaphores.size());
+        std::fill(signalValues.begin(), signalValues.end(), 0);
+        signalValues.back() = value;
+        Span<uint64_t> waitValues = t_context.m_frameArena.allocate<uint64_t>(t_waitSemaphores.size());
+        std::fill(waitValues.begin(), waitValues.end(), 0);
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+        timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+        VkSubmitInfo si{};
+        si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        si.pNext = &timelineInfo;
+        si.waitSemaphoreCount = static_cast<uint32_t>(t_waitSemaphores.size());
+        si.pWaitSemaphores = t_waitSemaphores.data();
+        si.pWaitDstStageMask = t_waitStages.data();
+        si.commandBufferCount = static_cast<uint32_t>(t_commandBuffers.size());
+        si.pCommandBuffers = t_commandBuffers.data();
+        si.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+        si.pSignalSemaphores = signalSemaphores.data();
+
+        VK_CHECK(vkQueueSubmit(t_context.m_graphicsQueue, 1, &si, VK_NULL_HANDLE));
+
+        t_context.m_timelineValue = value;
+        t_context.m_frames[t_context.m_currentFrame].m_submitValue = value;
+        t_context.m_frames[t_context.m_vertexRegion].m_vertexReadValue = value;
+        t_context.m_currentFrame = (t_context.m_currentFrame + 1) % t_context.m_frames.size();
+        return value;
+    }
+
+    void waitForTimeline(const VulkanContext &t_context, uint64_t t_value)
+    {
+        if (t_value == 0)
+            return;
+
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &t_context.m_timeline;
+        waitInfo.pValues = &t_value;
+        VK_CHECK(vkWaitSemaphores(t_context.m_device, &waitInfo, UINT64_MAX));
+    }
+
+    void recordCommandBuffer(VulkanContext &t_context, WindowContext &t_window, uint32_t t_imageIndex, Span<const CurveRange> t_curves)
+    {
+        VkCommandBuffer commandBuffer = t_window.m_commandBuffers[t_context.m_currentFrame];
 
-        // record command buffer
-        vkResetCommandBuffer(t_context.m_commandBuffers[imageIndex], 0);
         VkCommandBufferBeginInfo bi{};
         bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        vkBeginCommandBuffer(t_context.m_commandBuffers[imageIndex], &bi);
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(commandBuffer, &bi));
+        recordDrawCommands(t_context, t_window, commandBuffer, t_imageIndex, t_curves);
+        VK_CHECK(vkEndCommandBuffer(commandBuffer));
+    }
 
+    void recordDrawCommands(VulkanContext &t_context, WindowContext &t_window, VkCommandBuffer t_commandBuffer, uint32_t t_imageIndex,
+                            Span<const CurveRange> t_curves)
+    {
         VkRenderPassBeginInfo rpbi{};
         rpbi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         rpbi.renderPass = t_context.m_renderPass;
-        rpbi.framebuffer = t_context.m_swapChainFramebuffers[imageIndex];
+        rpbi.framebuffer = t_window.m_swapChainFramebuffers[t_imageIndex];
         rpbi.renderArea.offset = {0, 0};
-        rpbi.renderArea.extent = t_context.m_swapChainExtent;
+        rpbi.renderArea.extent = t_window.m_swapChainExtent;
         VkClearValue clearColor = {{{0.1f, 0.1f, 0.1f, 1.0f}}};
         rpbi.clearValueCount = 1;
         rpbi.pClearValues = &clearColor;
 
-        vkCmdBeginRenderPass(t_context.m_commandBuffers[imageIndex],
+        vkCmdBeginRenderPass(t_commandBuffer,
                              &rpbi,
                              VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(t_context.m_commandBuffers[imageIndex],
+        vkCmdBindPipeline(t_commandBuffer,
                           VK_PIPELINE_BIND_POINT_GRAPHICS,
                           t_context.m_graphicsPipeline);
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(t_context.m_commandBuffers[imageIndex],
-                               0, 1,
-                               &t_context.m_vertexBuffer,
-                               offsets);
-        vkCmdDraw(t_context.m_commandBuffers[imageIndex],
-                  static_cast<uint32_t>(t_vertices.size()),
-                  1, 0, 0);
-        vkCmdEndRenderPass(t_context.m_commandBuffers[imageIndex]);
-        vkEndCommandBuffer(t_context.m_commandBuffers[imageIndex]);
-
-        // submit command buffer
-        VkSemaphore waitSemaphores[] = {
-            t_context.m_imageAvailableSemaphores[t_context.m_currentFrame]};
-        VkSemaphore signalSemaphores[] = {
-            t_context.m_renderFinishedSemaphores[t_context.m_currentFrame]};
-        VkPipelineStageFlags waitStages[] = {
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        VkSubmitInfo si{};
-        si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        si.waitSemaphoreCount = 1;
-        si.pWaitSemaphores = waitSemaphores;
-        si.pWaitDstStageMask = waitStages;
-        si.commandBufferCount = 1;
-        si.pCommandBuffers = &t_context.m_commandBuffers[imageIndex];
-        si.signalSemaphoreCount = 1;
-        si.pSignalSemaphores = signalSemaphores;
-
-        vkResetFences(t_context.m_device, 1,
-                      &t_context.m_inFlightFences[t_context.m_currentFrame]);
-        VK_CHECK(vkQueueSubmit(t_context.m_graphicsQueue,
-                               1, &si,
-                               t_context.m_inFlightFences[t_context.m_currentFrame]));
-
-        // present image
-        VkPresentInfoKHR pi{};
-        pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        pi.waitSemaphoreCount = 1;
-        pi.pWaitSemaphores = signalSemaphores;
-        pi.swapchainCount = 1;
-        pi.pSwapchains = &t_context.m_swapChain;
-        pi.pImageIndices = &imageIndex;
-        vkQueuePresentKHR(t_context.m_presentQueue, &pi);
-
-        t_context.m_currentFrame =
-            (t_context.m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(t_window.m_swapChainExtent.width);
+        viewport.height = static_cast<float>(t_window.m_swapChainExtent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(t_commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = t_window.m_swapChainExtent;
+        vkCmdSetScissor(t_commandBuffer, 0, 1, &scissor);
+
+        vkCmdPushConstants(t_commandBuffer,
+                           t_context.m_pipelineLayout,
+                           VK_SHADER_STAGE_VERTEX_BIT,
+                           offsetof(LinePushConstants, m_view), sizeof(view::ViewTransform),
+                           &t_window.m_view);
+
+        // each curve is bound at its own offset so gl_VertexIndex starts at 0 for the x of y-only formats
+        VkDeviceSize stride = sine::vertexStride(t_context.m_vertexFormat);
+        VkDeviceSize regionOffset = t_context.m_vertexRegion * t_context.m_vertexRegionSize;
+        for (const auto &curve : t_curves)
+        {
+            VkDeviceSize offsets[] = {regionOffset + curve.m_firstVertex * stride};
+            vkCmdBindVertexBuffers(t_commandBuffer,
+                                   0, 1,
+                                   &t_context.m_vertexBuffer,
+                                   offsets);
+            vkCmdPushConstants(t_commandBuffer,
+                               t_context.m_pipelineLayout,
+                               VK_SHADER_STAGE_VERTEX_BIT,
+                               offsetof(LinePushConstants, m_decode), sizeof(VertexDecode),
+                               &curve.m_decode);
+            vkCmdDraw(t_commandBuffer, curve.m_vertexCount, 1, 0, 0);
+        }
+        vkCmdEndRenderPass(t_commandBuffer);
+    }
+
+    void renderFrame(VulkanContext &t_context, const std::vector<Vertex> &t_vertices)
+    {
+        CurveRange curve{0, static_cast<uint32_t>(t_vertices.size()), VertexDecode{}};
+        renderFrame(t_context, t_vertices, {&curve, 1});
+    }
+
+    void renderFrame(VulkanContext &t_context, const std::vector<Vertex> &t_vertices, Span<const CurveRange> t_curves)
+    {
+        // update vertex buffer
+        uploadVertices(t_context, t_vertices);
+        drawFrame(t_context, t_curves);
+    }
+
+    FrameResult drawFrame(VulkanContext &t_context, Span<const CurveRange> t_curves)
+    {
+        const size_t frame = beginFrame(t_context);
+
+        // what the windows taking part in this frame contribute to the shared submit and present,
+        // sized for all windows and filled up to the counts below
+        ArenaScope scratch(t_context.m_frameArena);
+        FrameArena &arena = t_context.m_frameArena;
+        const size_t windowCount = t_context.m_windows.size();
+        Span<size_t> windowIndices = arena.allocate<size_t>(windowCount);
+        Span<uint32_t> imageIndices = arena.allocate<uint32_t>(windowCount);
+        Span<VkCommandBuffer> commandBuffers = arena.allocate<VkCommandBuffer>(windowCount);
+        Span<VkSemaphore> waitSemaphores = arena.allocate<VkSemaphore>(windowCount);
+        Span<VkPipelineStageFlags> waitStages = arena.allocate<VkPipelineStageFlags>(windowCount);
+        Span<VkSemaphore> signalSemaphores = arena.allocate<VkSemaphore>(windowCount);
+        Span<VkSwapchainKHR> swapChains = arena.allocate<VkSwapchainKHR>(windowCount);
+        size_t recorded = 0;
+        size_t presented = 0;
+        FrameResult frameResult;
+
+        for (size_t i = 0; i < t_context.m_windows.size(); i++)
+        {
+            WindowContext &window = t_context.m_windows[i];
+            if (window.m_swapChainStale)
+            {
+                recreateSwapChain(t_context, i);
+                if (window.m_swapChainStale)
+                    continue;
+            }
+
+            // offscreen images are owned per frame slot, no acquire needed
+            uint32_t imageIndex = static_cast<uint32_t>(frame);
+            if (!t_context.m_headless)
+            {
+                VkResult result = vkAcquireNextImageKHR(
+                    t_context.m_device,
+                    window.m_swapChain,
+                    UINT64_MAX,
+                    window.m_imageAvailableSemaphores[frame],
+                    VK_NULL_HANDLE,
+                    &imageIndex);
+                // the semaphore isn't signaled in this case, so the window can simply sit this frame out
+                if (result == VK_ERROR_OUT_OF_DATE_KHR)
+                {
+                    t_context.m_debug.m_counters.m_outOfDateSwapchains++;
+                    recreateSwapChain(t_context, i);
+                    frameResult.m_retrySwapchain = true;
+                    continue;
+                }
+                // still presentable, the present below reports it again and rebuilds the swapchain
+                if (result == VK_SUBOPTIMAL_KHR)
+                {
+                    t_context.m_debug.m_counters.m_suboptimalAcquires++;
+                }
+                else if (result != VK_SUCCESS)
+                {
+                    throw VulkanError(result, "vkAcquireNextImageKHR", __FILE__, __LINE__);
+                }
+                waitSemaphores[presented] = window.m_imageAvailableSemaphores[frame];
+                waitStages[presented] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                signalSemaphores[presented] = window.m_renderFinishedSemaphores[imageIndex];
+                swapChains[presented] = window.m_swapChain;
+                presented++;
+            }
+
+            // record command buffer
+            recordCommandBuffer(t_context, window, imageIndex, t_curves);
+            commandBuffers[recorded] = window.m_commandBuffers[frame];
+            windowIndices[recorded] = i;
+            imageIndices[recorded] = imageIndex;
+            recorded++;
+        }
+
+        if (recorded == 0)
+        {
+            // every window is minimized, sleep until something happens to one of them
+            if (!frameResult.m_retrySwapchain && !t_context.m_headless)
+                glfwWaitEvents();
+            return frameResult;
+        }
+
+        // submit command buffers of all windows at once
+        submitFrame(t_context, {commandBuffers.data(), recorded}, {waitSemaphores.data(), presented},
+                    {waitStages.data(), presented}, {signalSemaphores.data(), presented});
+        frameResult.m_submitted = true;
+
+        // present all images at once, each swapchain reports its own result
+        if (!t_context.m_headless)
+        {
+            Span<VkResult> results = arena.allocate<VkResult>(presented);
+            std::fill(results.begin(), results.end(), VK_SUCCESS);
+            VkPresentInfoKHR pi{};
+            pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+            pi.waitSemaphoreCount = static_cast<uint32_t>(presented);
+            pi.pWaitSemaphores = signalSemaphores.data();
+            pi.swapchainCount = static_cast<uint32_t>(presented);
+            pi.pSwapchains = swapChains.data();
+            pi.pImageIndices = imageIndices.data();
+            pi.pResults = results.data();
+            VkResult presentResult = vkQueuePresentKHR(t_context.m_presentQueue, &pi);
+            // out of date and suboptimal swapchains are handled one by one below, anything else
+            // (device or surface lost) would otherwise only show up as a hang at the next wait
+            if (presentResult != VK_SUCCESS && presentResult != VK_SUBOPTIMAL_KHR && presentResult != VK_ERROR_OUT_OF_DATE_KHR)
+            {
+                throw VulkanError(presentResult, "vkQueuePresentKHR", __FILE__, __LINE__);
+            }
+
+            for (size_t k = 0; k < presented; k++)
+            {
+                if (results[k] == VK_SUCCESS)
+                    continue;
+                if (results[k] == VK_SUBOPTIMAL_KHR)
+                {
+                    t_context.m_debug.m_counters.m_suboptimalPresents++;
+                    recreateSwapChain(t_context, windowIndices[k]);
+                }
+                else if (results[k] == VK_ERROR_OUT_OF_DATE_KHR)
+                {
+                    t_context.m_debug.m_counters.m_outOfDateSwapchains++;
+                    recreateSwapChain(t_context, windowIndices[k]);
+                    // this window never showed the frame
+                    frameResult.m_retrySwapchain = true;
+                }
+                else
+                {
+                    throw VulkanError(results[k], "vkQueuePresentKHR", __FILE__, __LINE__);
+                }
+            }
+        }
+
+        return frameResult;
+    }
+
+    void recreateSwapChain(VulkanContext &t_context, size_t t_windowIndex)
+    {
+        // offscreen images don't depend on any window
+        if (t_context.m_headless)
+            return;
+
+        WindowContext &window = t_context.m_windows[t_windowIndex];
+
+        // a minimized window has a zero sized framebuffer, it is rebuilt once it is visible again
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window.m_window, &width, &height);
+        if (width == 0 || height == 0)
+        {
+            window.m_swapChainStale = true;
+            return;
+        }
+
+        vkDeviceWaitIdle(t_context.m_device);
+
+        VulkanHelpers::cleanupSwapChain(t_context, window);
+        VulkanHelpers::createSwapChain(t_context, window);
+        VulkanHelpers::createImageViews(t_context, window);
+        VulkanHelpers::createFramebuffers(t_context, window);
+        VulkanHelpers::createImageSyncObjects(t_context, window);
+        window.m_swapChainStale = false;
     }
 
     void cleanup(VulkanContext &t_context)
     {
+        // initialization may have failed before a device existed
+        if (t_context.m_device == VK_NULL_HANDLE)
+        {
+            for (auto &window : t_context.m_windows)
+                VulkanHelpers::destroyWindow(t_context, window);
+            t_context.m_windows.clear();
+            if (t_context.m_instance != VK_NULL_HANDLE)
+            {
+                VulkanDebug::destroyMessenger(t_context.m_debug, t_context.m_instance);
+                vkDestroyInstance(t_context.m_instance, nullptr);
+            }
+            t_context.m_instance = VK_NULL_HANDLE;
+            return;
+        }
+
         vkDeviceWaitIdle(t_context.m_device);
 
         vkDestroyBuffer(t_context.m_device, t_context.m_vertexBuffer, nullptr);
         vkFreeMemory(t_context.m_device, t_context.m_vertexBufferMemory, nullptr);
 
-        for (auto &f : t_context.m_inFlightFences)
-            vkDestroyFence(t_context.m_device, f, nullptr);
-        for (auto &s : t_context.m_renderFinishedSemaphores)
-            vkDestroySemaphore(t_context.m_device, s, nullptr);
-        for (auto &s : t_context.m_imageAvailableSemaphores)
-            vkDestroySemaphore(t_context.m_device, s, nullptr);
+        // windows free their command buffers, so they go before the pools
+        for (auto &window : t_context.m_windows)
+            VulkanHelpers::destroyWindow(t_context, window);
+        t_context.m_windows.clear();
 
-        vkDestroyCommandPool(t_context.m_device, t_context.m_commandPool, nullptr);
-
-        for (auto &fb : t_context.m_swapChainFramebuffers)
-            vkDestroyFramebuffer(t_context.m_device, fb, nullptr);
+        for (auto &slot : t_context.m_frames)
+            vkDestroyCommandPool(t_context.m_device, slot.m_commandPool, nullptr);
+        t_context.m_frames.clear();
+        vkDestroySemaphore(t_context.m_device, t_context.m_timeline, nullptr);
+        t_context.m_timeline = VK_NULL_HANDLE;
 
         vkDestroyPipeline(t_context.m_device, t_context.m_graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(t_context.m_device, t_context.m_pipelineLayout, nullptr);
         vkDestroyRenderPass(t_context.m_device, t_context.m_renderPass, nullptr);
 
-        for (auto &iv : t_context.m_swapChainImageViews)
-            vkDestroyImageView(t_context.m_device, iv, nullptr);
-
-        vkDestroySwapchainKHR(t_context.m_device, t_context.m_swapChain, nullptr);
         vkDestroyDevice(t_context.m_device, nullptr);
-        vkDestroySurfaceKHR(t_context.m_instance, t_context.m_surface, nullptr);
+        VulkanDebug::destroyMessenger(t_context.m_debug, t_context.m_instance);
         vkDestroyInstance(t_context.m_instance, nullptr);
+        t_context.m_device = VK_NULL_HANDLE;
+        t_context.m_instance = VK_NULL_HANDLE;
     }
-}
\ No newline at end of file
+}
@@ -5,51 +5,173 @@
 #include <vector>
 #include <set>
 #include "sine.hpp"
+#include "view.hpp"
+#include "arena.hpp"
+#include "VulkanDebug.hpp"
 
-// Maximum number of frames that can be processed concurrently
-constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+// Frames the CPU records ahead of the GPU unless VulkanContext::m_framesInFlight says otherwise
+constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
 
-// All data needed for Vulkan to function
+// Number of vertices each frame slot's vertex region starts with, it grows on demand
+constexpr VkDeviceSize INITIAL_VERTEX_CAPACITY = 200;
+
+// Push constant block of line.vert
+struct LinePushConstants {
+    view::ViewTransform m_view;
+    VertexDecode m_decode;
+};
+
+// Per window state: the surface and everything built on top of its swapchain.
+// Headless contexts have a single one holding the offscreen images instead
+struct WindowContext {
+    GLFWwindow* m_window = nullptr;
+    VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+
+    VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
+    std::vector<VkImage> m_swapChainImages;
+    VkExtent2D m_swapChainExtent{};
+    std::vector<VkImageView> m_swapChainImageViews;
+    std::vector<VkFramebuffer> m_swapChainFramebuffers;
+    VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    // Set while the window is minimized, it sits out frames until its swapchain can be rebuilt
+    bool m_swapChainStale = false;
+
+    // One per frame slot, allocated from that slot's command pool
+    std::vector<VkCommandBuffer> m_commandBuffers;
+    // One per frame slot, the acquire of that slot's frame signals it
+    std::vector<VkSemaphore> m_imageAvailableSemaphores;
+    // One per swapchain image, its present waits on it until the image is acquired again
+    std::vector<VkSemaphore> m_renderFinishedSemaphores;
+
+    // Pushed to line.vert when recording, changing it doesn't touch the vertex buffer
+    view::ViewTransform m_view;
+
+    std::vector<VkDeviceMemory> m_offscreenImageMemory;
+};
+
+// Everything one frame in flight records into. A slot is only reused once the
+// timeline semaphore has reached the value its last submit signals
+struct FrameSlot {
+    // Reset as a whole when the slot comes around again, instead of buffer by buffer
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    // Timeline value of the slot's last submit, 0 before its first
+    uint64_t m_submitValue = 0;
+    // Timeline value of the last frame that drew from the slot's vertex region,
+    // uploading into the region waits for it
+    uint64_t m_vertexReadValue = 0;
+};
+
+// Device state shared by all windows
 struct VulkanContext {
     VkInstance m_instance = VK_NULL_HANDLE;
-    VkSurfaceKHR m_surface = VK_NULL_HANDLE;
     VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
     VkDevice m_device = VK_NULL_HANDLE;
     VkQueue m_graphicsQueue = VK_NULL_HANDLE;
     VkQueue m_presentQueue = VK_NULL_HANDLE;
+    uint32_t m_graphicsQueueFamily = 0;
+    uint32_t m_presentQueueFamily = 0;
 
-    VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
-    std::vector<VkImage> m_swapChainImages;
-    VkFormat m_swapChainFormat;
-    VkExtent2D m_swapChainExtent;
-    std::vector<VkImageView> m_swapChainImageViews;
+    // Every window renders with the same render pass and pipeline, so all swapchains use this format
+    VkFormat m_swapChainImageFormat = VK_FORMAT_UNDEFINED;
+    // Requested before initialize or addWindow, falls back to FIFO when a surface doesn't support it
+    VkPresentModeKHR m_preferredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
 
     VkRenderPass m_renderPass = VK_NULL_HANDLE;
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
 
-    std::vector<VkFramebuffer> m_swapChainFramebuffers;
-    VkCommandPool m_commandPool = VK_NULL_HANDLE;
-    std::vector<VkCommandBuffer> m_commandBuffers;
-
-    std::vector<VkSemaphore> m_imageAvailableSemaphores;
-    std::vector<VkSemaphore> m_renderFinishedSemaphores;
-    std::vector<VkFence> m_inFlightFences;
+    // Frames the CPU may record ahead of the GPU, set before initialize
+    uint32_t m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    std::vector<FrameSlot> m_frames;
     size_t m_currentFrame = 0;
+    // Every submit signals the next value of this timeline semaphore, so one counter tracks
+    // how far the GPU got through all frames of all windows
+    VkSemaphore m_timeline = VK_NULL_HANDLE;
+    uint64_t m_timelineValue = 0;
+
+    // Layout of the vertex buffer. Requested before initialize, replaced by the closest
+    // supported layout if the device can't fetch it
+    VertexFormat m_vertexFormat = VertexFormat::FLOAT2;
 
     VkBuffer m_vertexBuffer = VK_NULL_HANDLE;
     VkDeviceMemory m_vertexBufferMemory = VK_NULL_HANDLE;
+    VkDeviceSize m_vertexBufferSize = 0;
+    // The vertex buffer holds one region per frame slot. Uploads go into the current slot's
+    // region, so they don't wait for frames still drawing from the others
+    VkDeviceSize m_vertexRegionSize = 0;
+    // Slot whose region holds the latest upload, frames draw from it
+    size_t m_vertexRegion = 0;
+
+    // Offscreen targets used instead of a swapchain when running without a window
+    bool m_headless = false;
 
     std::vector<const char*> m_deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
-    GLFWwindow* m_window = nullptr;
-    VkFormat m_swapChainImageFormat;
+    std::vector<WindowContext> m_windows;
+
+    // Scratch memory of the current frame, reset by whoever runs the frame loop.
+    // drawFrame only borrows it and rewinds what it took before returning
+    FrameArena m_frameArena;
+
+    // Validation and object names, m_debug.m_requested is read by initialize. Its counters track
+    // suboptimal and out of date swapchains in every build
+    VulkanDebug::State m_debug;
+};
+
+// Memory helpers, also used by the offscreen export path
+uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags props);
+void createBuffer(VkPhysicalDevice phys, VkDevice dev, VkDeviceSize size, VkBufferUsageFlags usage,
+                  VkMemoryPropertyFlags props, VkBuffer& buffer, VkDeviceMemory& bufferMem);
+
+// What drawFrame got done
+struct FrameResult {
+    // Command buffers of at least one window were submitted
+    bool m_submitted = false;
+    // A window sat the frame out or lost it because its swapchain was out of date,
+    // the frame has to be drawn again once the swapchain is rebuilt
+    bool m_retrySwapchain = false;
 };
 
 namespace InitVulkan {
-    // Called once at startup
+    // Called once at startup, creates the device and the first window's swapchain
     void initialize(GLFWwindow* window, VulkanContext& context);
+    // Renders into another window from the same device, returns its index in context.m_windows.
+    // Its surface has to support the format the first window picked
+    size_t addWindow(VulkanContext& context, GLFWwindow* window);
+    // Destroys a window's swapchain and surface, later windows move down one index
+    void removeWindow(VulkanContext& context, size_t windowIndex);
+    // Called once at startup when rendering into offscreen images, no window or surface needed.
+    // Every frame slot gets its own offscreen image, image i belongs to slot i
+    void initializeHeadless(VulkanContext& context, uint32_t width, uint32_t height);
+    // Copies vertices into the current frame slot's vertex region, growing the regions when too small.
+    // Requires the FLOAT2 vertex format
+    void uploadVertices(VulkanContext& context, const std::vector<Vertex>& vertices);
+    // Same for data already packed in the context's vertex format.
+    // Curve ranges are relative to the start of the upload
+    void uploadVertices(VulkanContext& context, const void* data, VkDeviceSize size);
+    // Waits until the current frame slot is free and resets its command pool, returns the slot index
+    uint32_t beginFrame(VulkanContext& context);
+    // Submits command buffers recorded for the current slot, signalling the next timeline value,
+    // and moves on to the next slot. Returns the timeline value the submit signals
+    uint64_t submitFrame(VulkanContext& context, Span<const VkCommandBuffer> commandBuffers,
+                         Span<const VkSemaphore> waitSemaphores = {}, Span<const VkPipelineStageFlags> waitStages = {},
+                         Span<const VkSemaphore> signalSemaphores = {});
+    // Blocks until the GPU has finished every submit up to the given timeline value
+    void waitForTimeline(const VulkanContext& context, uint64_t value);
+    // Records the draw commands for one swapchain (or offscreen) image of a window into the
+    // window's command buffer of the current frame slot, after beginFrame
+    void recordCommandBuffer(VulkanContext& context, WindowContext& window, uint32_t imageIndex, Span<const CurveRange> curves);
+    // Records just the render pass into a command buffer that is already recording
+    void recordDrawCommands(VulkanContext& context, WindowContext& window, VkCommandBuffer commandBuffer, uint32_t imageIndex,
+                            Span<const CurveRange> curves);
     // Called each frame
     void renderFrame(VulkanContext& context, const std::vector<Vertex>& vertices);
+    // Called each frame, draws every range of the vertex data as its own curve
+    void renderFrame(VulkanContext& context, const std::vector<Vertex>& vertices, Span<const CurveRange> curves);
+    // Draws the vertices already in the vertex buffer into every window, each with its own view,
+    // with a single submit and present
+    FrameResult drawFrame(VulkanContext& context, Span<const CurveRange> curves);
+    // Rebuilds a window's swapchain and everything depending on it, e.g. after a resize
+    void recreateSwapChain(VulkanContext& context, size_t windowIndex = 0);
     // Called at exit
     void cleanup(VulkanContext& context);
 }
@@ -0,0 +1,211 @@
+#include "VulkanDebug.hpp"
+#include <cstring>
+#include <iostream>
+
+// "vkMapMemory(device, memory, ...)" as VK_CHECK stringizes it, only the function name is worth showing
+static std::string callName(const char* t_call) {
+    std::string call = t_call;
+    return call.substr(0, call.find('('));
+}
+
+static std::string fileName(const char* t_path) {
+    std::string path = t_path;
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+VulkanError::VulkanError(VkResult t_result, const char* t_call, const char* t_file, int t_line)
+    : std::runtime_error(callName(t_call) + " failed with " + VulkanDebug::resultName(t_result) + " (" + fileName(t_file) +
+                         ":" + std::to_string(t_line) + ")"),
+      m_result(t_result) {}
+
+std::string VulkanDebug::resultName(VkResult t_result) {
+    switch (t_result) {
+        case VK_SUCCESS: return "VK_SUCCESS";
+        case VK_NOT_READY: return "VK_NOT_READY";
+        case VK_TIMEOUT: return "VK_TIMEOUT";
+        case VK_EVENT_SET: return "VK_EVENT_SET";
+        case VK_EVENT_RESET: return "VK_EVENT_RESET";
+        case VK_INCOMPLETE: return "VK_INCOMPLETE";
+        case VK_ERROR_OUT_OF_HOST_MEMORY: return "VK_ERROR_OUT_OF_HOST_MEMORY";
+        case VK_ERROR_OUT_OF_DEVICE_MEMORY: return "VK_ERROR_OUT_OF_DEVICE_MEMORY";
+        case VK_ERROR_INITIALIZATION_FAILED: return "VK_ERROR_INITIALIZATION_FAILED";
+        case VK_ERROR_DEVICE_LOST: return "VK_ERROR_DEVICE_LOST";
+        case VK_ERROR_MEMORY_MAP_FAILED: return "VK_ERROR_MEMORY_MAP_FAILED";
+        case VK_ERROR_LAYER_NOT_PRESENT: return "VK_ERROR_LAYER_NOT_PRESENT";
+        case VK_ERROR_EXTENSION_NOT_PRESENT: return "VK_ERROR_EXTENSION_NOT_PRESENT";
+        case VK_ERROR_FEATURE_NOT_PRESENT: return "VK_ERROR_FEATURE_NOT_PRESENT";
+        case VK_ERROR_INCOMPATIBLE_DRIVER: return "VK_ERROR_INCOMPATIBLE_DRIVER";
+        case VK_ERROR_TOO_MANY_OBJECTS: return "VK_ERROR_TOO_MANY_OBJECTS";
+        case VK_ERROR_FORMAT_NOT_SUPPORTED: return "VK_ERROR_FORMAT_NOT_SUPPORTED";
+        case VK_ERROR_FRAGMENTED_POOL: return "VK_ERROR_FRAGMENTED_POOL";
+        case VK_ERROR_UNKNOWN: return "VK_ERROR_UNKNOWN";
+        case VK_ERROR_OUT_OF_POOL_MEMORY: return "VK_ERROR_OUT_OF_POOL_MEMORY";
+        case VK_ERROR_SURFACE_LOST_KHR: return "VK_ERROR_SURFACE_LOST_KHR";
+        case VK_ERROR_NATIVE_WINDOW_IN_USE_KHR: return "VK_ERROR_NATIVE_WINDOW_IN_USE_KHR";
+        case VK_SUBOPTIMAL_KHR: return "VK_SUBOPTIMAL_KHR";
+        case VK_ERROR_OUT_OF_DATE_KHR: return "VK_ERROR_OUT_OF_DATE_KHR";
+        case VK_ERROR_VALIDATION_FAILED_EXT: return "VK_ERROR_VALIDATION_FAILED_EXT";
+        default: return "VkResult " + std::to_string(static_cast<int>(t_result));
+    }
+}
+
+#ifdef TRIG_VULKAN_DEBUG
+static const char* VALIDATION_LAYER = "VK_LAYER_KHRONOS_validation";
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL messengerCallback(VkDebugUtilsMessageSeverityFlagBitsEXT t_severity,
+                                                        VkDebugUtilsMessageTypeFlagsEXT t_type,
+                                                        const VkDebugUtilsMessengerCallbackDataEXT* t_data, void* t_userData) {
+    auto* counters = static_cast<VulkanDebug::Counters*>(t_userData);
+    const char* label = "Vulkan";
+    if (t_type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) {
+        counters->m_performanceWarnings++;
+        label = "Vulkan performance";
+    }
+    if (t_severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        counters->m_validationErrors++;
+    } else if (t_severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+        counters->m_validationWarnings++;
+    }
+    std::cerr << label << ": " << (t_data->pMessageIdName ? t_data->pMessageIdName : "") << " " << t_data->pMessage
+              << std::endl;
+    // never abort the call that triggered the message
+    return VK_FALSE;
+}
+
+// Warnings and errors of every kind, performance ones included
+static VkDebugUtilsMessengerCreateInfoEXT messengerInfo(VulkanDebug::State& t_state) {
+    VkDebugUtilsMessengerCreateInfoEXT info{};
+    info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+    info.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    info.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+                       VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+    info.pfnUserCallback = messengerCallback;
+    info.pUserData = &t_state.m_counters;
+    return info;
+}
+
+static bool hasLayer(const char* t_name) {
+    uint32_t count = 0;
+    vkEnumerateInstanceLayerProperties(&count, nullptr);
+    std::vector<VkLayerProperties> layers(count);
+    vkEnumerateInstanceLayerProperties(&count, layers.data());
+    for (const auto& layer : layers) {
+        if (std::strcmp(layer.layerName, t_name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool hasInstanceExtension(const char* t_name) {
+    uint32_t count = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> extensions(count);
+    vkEnumerateInstanceExtensionProperties(nullptr, &count, extensions.data());
+    for (const auto& extension : extensions) {
+        if (std::strcmp(extension.extensionName, t_name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+void VulkanDebug::addInstanceRequirements(State& t_state, std::vector<const char*>& t_layers,
+                                          std::vector<const char*>& t_extensions,
+                                          VkDebugUtilsMessengerCreateInfoEXT& t_messengerInfo) {
+    t_state.m_enabled = false;
+    t_messengerInfo = {};
+#ifdef TRIG_VULKAN_DEBUG
+    if (!t_state.m_requested) {
+        return;
+    }
+    // validation is a development aid, a machine without the SDK still runs the program
+    if (!hasLayer(VALIDATION_LAYER) || !hasInstanceExtension(VK_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        std::cerr << "Warning: " << VALIDATION_LAYER << " or " << VK_EXT_DEBUG_UTILS_EXTENSION_NAME
+                  << " isn't installed, running without validation" << std::endl;
+        return;
+    }
+    t_layers.push_back(VALIDATION_LAYER);
+    t_extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    // also covers messages from vkCreateInstance and vkDestroyInstance, when no messenger exists yet
+    t_messengerInfo = messengerInfo(t_state);
+    t_state.m_enabled = true;
+#else
+    (void)t_layers;
+    (void)t_extensions;
+#endif
+}
+
+void VulkanDebug::createMessenger(State& t_state, VkInstance t_instance) {
+#ifdef TRIG_VULKAN_DEBUG
+    if (!t_state.m_enabled) {
+        return;
+    }
+    VkDebugUtilsMessengerCreateInfoEXT info = messengerInfo(t_state);
+    auto create = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+        vkGetInstanceProcAddr(t_instance, "vkCreateDebugUtilsMessengerEXT"));
+    t_state.m_setObjectName = reinterpret_cast<PFN_vkSetDebugUtilsObjectNameEXT>(
+        vkGetInstanceProcAddr(t_instance, "vkSetDebugUtilsObjectNameEXT"));
+    if (create == nullptr) {
+        throw std::runtime_error("VK_EXT_debug_utils is enabled but vkCreateDebugUtilsMessengerEXT is missing");
+    }
+    VkResult result = create(t_instance, &info, nullptr, &t_state.m_messenger);
+    if (result != VK_SUCCESS) {
+        throw VulkanError(result, "vkCreateDebugUtilsMessengerEXT", __FILE__, __LINE__);
+    }
+#else
+    (void)t_state;
+    (void)t_instance;
+#endif
+}
+
+void VulkanDebug::destroyMessenger(State& t_state, VkInstance t_instance) {
+#ifdef TRIG_VULKAN_DEBUG
+    if (t_state.m_messenger == VK_NULL_HANDLE) {
+        return;
+    }
+    auto destroy = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+        vkGetInstanceProcAddr(t_instance, "vkDestroyDebugUtilsMessengerEXT"));
+    if (destroy != nullptr) {
+        destroy(t_instance, t_state.m_messenger, nullptr);
+    }
+    t_state.m_messenger = VK_NULL_HANDLE;
+    t_state.m_setObjectName = nullptr;
+#else
+    (void)t_state;
+    (void)t_instance;
+#endif
+}
+
+#ifdef TRIG_VULKAN_DEBUG
+void VulkanDebug::setObjectName(const State& t_state, VkDevice t_device, VkObjectType t_type, uint64_t t_handle,
+                                const char* t_name) {
+    if (t_state.m_setObjectName == nullptr || t_handle == 0) {
+        return;
+    }
+    VkDebugUtilsObjectNameInfoEXT info{};
+    info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+    info.objectType = t_type;
+    info.objectHandle = t_handle;
+    info.pObjectName = t_name;
+    t_state.m_setObjectName(t_device, &info);
+}
+#endif
+
+void VulkanDebug::printCounters(std::ostream& t_out, const Counters& t_counters) {
+    const std::pair<uint64_t, const char*> lines[] = {
+        {t_counters.m_suboptimalAcquires, "suboptimal swapchain acquires"},
+        {t_counters.m_suboptimalPresents, "suboptimal swapchain presents"},
+        {t_counters.m_outOfDateSwapchains, "out of date swapchains"},
+        {t_counters.m_validationErrors, "validation errors"},
+        {t_counters.m_validationWarnings, "validation warnings"},
+        {t_counters.m_performanceWarnings, "performance warnings"},
+    };
+    for (const auto& [count, what] : lines) {
+        if (count > 0) {
+            t_out << "Vulkan: " << count << " " << what << std::endl;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Validation layer, debug messenger and object names. Only built with TRIG_VULKAN_DEBUG (Debug builds or
+// the TRIG_VULKAN_DEBUG CMake option), and even then switchable at run time. Without it the render loop
+// keeps just the result checks it needs anyway and a few counters
+#ifdef TRIG_VULKAN_DEBUG
+constexpr bool VULKAN_DEBUG_BUILD = true;
+#else
+constexpr bool VULKAN_DEBUG_BUILD = false;
+#endif
+
+// A failed Vulkan call. Keeps the result so callers can tell a lost device from a stale swapchain
+class VulkanError : public std::runtime_error {
+public:
+    VulkanError(VkResult t_result, const char* t_call, const char* t_file, int t_line);
+    VkResult result() const { return m_result; }
+
+private:
+    VkResult m_result;
+};
+
+#define VK_CHECK(fn)                                                    \
+    do {                                                                \
+        VkResult vkCheckResult = (fn);                                  \
+        if (vkCheckResult != VK_SUCCESS) {                              \
+            throw VulkanError(vkCheckResult, #fn, __FILE__, __LINE__);  \
+        }                                                               \
+    } while (false)
+
+namespace VulkanDebug {
+    // Things that cost frames without failing. The swapchain counts are always kept,
+    // the message counts only while the messenger is installed
+    struct Counters {
+        uint64_t m_suboptimalAcquires = 0;
+        uint64_t m_suboptimalPresents = 0;
+        uint64_t m_outOfDateSwapchains = 0;
+        uint64_t m_validationErrors = 0;
+        uint64_t m_validationWarnings = 0;
+        uint64_t m_performanceWarnings = 0;
+    };
+
+    struct State {
+        // Requested before initialize, has no effect in builds without TRIG_VULKAN_DEBUG
+        bool m_requested = VULKAN_DEBUG_BUILD;
+        // Set when the layer and VK_EXT_debug_utils were actually there
+        bool m_enabled = false;
+        VkDebugUtilsMessengerEXT m_messenger = VK_NULL_HANDLE;
+        PFN_vkSetDebugUtilsObjectNameEXT m_setObjectName = nullptr;
+        // Written by the messenger callback, which runs on the thread making the Vulkan call
+        Counters m_counters;
+    };
+
+    // "VK_ERROR_DEVICE_LOST" and so on, the number for results it doesn't know
+    std::string resultName(VkResult t_result);
+
+    // Adds the validation layer and debug utils extension to the instance's lists when requested and
+    // installed, and fills t_messengerInfo to chain into instance creation. Decides m_enabled
+    void addInstanceRequirements(State& t_state, std::vector<const char*>& t_layers, std::vector<const char*>& t_extensions,
+                                 VkDebugUtilsMessengerCreateInfoEXT& t_messengerInfo);
+    void createMessenger(State& t_state, VkInstance t_instance);
+    void destroyMessenger(State& t_state, VkInstance t_instance);
+
+    // Shows up in validation messages and capture tools instead of the bare handle
+#ifdef TRIG_VULKAN_DEBUG
+    void setObjectName(const State& t_state, VkDevice t_device, VkObjectType t_type, uint64_t t_handle, const char* t_name);
+#else
+    inline void setObjectName(const State&, VkDevice, VkObjectType, uint64_t, const char*) {}
+#endif
+    template <typename Handle>
+    void setObjectName(const State& t_state, VkDevice t_device, VkObjectType t_type, Handle t_handle, const char* t_name) {
+        // handles are pointers on 64 bit platforms and integers elsewhere
+        setObjectName(t_state, t_device, t_type, (uint64_t)t_handle, t_name);
+    }
+
+    // One line per nonzero counter, nothing when all are zero
+    void printCounters(std::ostream& t_out, const Counters& t_counters);
+}
@@ -0,0 +1,62 @@
+#include "arena.hpp"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t t_blockSize) : m_blockSize(std::max<size_t>(t_blockSize, 64)) {}
+
+void* FrameArena::allocate(size_t t_bytes, size_t t_alignment) {
+    t_bytes = std::max<size_t>(t_bytes, 1);
+    // Walk the blocks from the current one on, a frame allocating the same as the last one
+    // ends up in the same blocks
+    while (m_current < m_blocks.size()) {
+        Block& block = m_blocks[m_current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.m_data.get());
+        uintptr_t aligned = (base + m_offset + t_alignment - 1) & ~(static_cast<uintptr_t>(t_alignment) - 1);
+        size_t offset = static_cast<size_t>(aligned - base);
+        if (offset + t_bytes <= block.m_size) {
+            m_used += offset + t_bytes - m_offset;
+            m_peak = std::max(m_peak, m_used);
+            m_offset = offset + t_bytes;
+            return block.m_data.get() + offset;
+        }
+        // the rest of this block goes unused until the next reset
+        m_used += block.m_size - m_offset;
+        ++m_current;
+        m_offset = 0;
+    }
+
+    // Out of blocks, growing geometrically keeps the block count low for big frames
+    Block block;
+    block.m_size = std::max(t_bytes + t_alignment, m_blocks.empty() ? m_blockSize : m_blocks.back().m_size * 2);
+    block.m_data = std::make_unique<uint8_t[]>(block.m_size);
+    m_blocks.push_back(std::move(block));
+    return allocate(t_bytes, t_alignment);
+}
+
+FrameArena::Marker FrameArena::mark() const {
+    return {m_current, m_offset};
+}
+
+void FrameArena::rewind(const Marker& t_marker) {
+    // bytes skipped at the end of blocks aren't tracked individually, recount them
+    size_t used = t_marker.m_offset;
+    for (size_t i = 0; i < t_marker.m_block && i < m_blocks.size(); ++i) {
+        used += m_blocks[i].m_size;
+    }
+    m_current = t_marker.m_block;
+    m_offset = t_marker.m_offset;
+    m_used = used;
+}
+
+void FrameArena::reset() {
+    m_current = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t FrameArena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : m_blocks) {
+        total += block.m_size;
+    }
+    return total;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Non-owning view of contiguous elements, the C++17 stand-in for std::span
+template <typename T>
+struct Span {
+    T* m_data = nullptr;
+    size_t m_size = 0;
+
+    Span() = default;
+    Span(T* t_data, size_t t_size) : m_data(t_data), m_size(t_size) {}
+    // vectors convert implicitly, so callers holding one don't have to change
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(std::vector<U>& t_vector) : m_data(t_vector.data()), m_size(t_vector.size()) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<const U (*)[], T (*)[]>>>
+    Span(const std::vector<U>& t_vector) : m_data(t_vector.data()), m_size(t_vector.size()) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(Span<U> t_other) : m_data(t_other.m_data), m_size(t_other.m_size) {}
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+    T& operator[](size_t t_index) const { return m_data[t_index]; }
+    T& front() const { return m_data[0]; }
+    T& back() const { return m_data[m_size - 1]; }
+};
+
+// Bump allocator for memory that only lives for one frame. reset() at the start of a frame
+// hands out the same blocks again, so once the biggest frame went through, allocating from it
+// never reaches malloc. Only for trivially destructible types, nothing is destroyed
+class FrameArena {
+public:
+    // Position in the arena, rewinding to it frees everything allocated after it was taken
+    struct Marker {
+        size_t m_block = 0;
+        size_t m_offset = 0;
+    };
+
+    explicit FrameArena(size_t t_blockSize = 1u << 16);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = default;
+    FrameArena& operator=(FrameArena&&) = default;
+
+    void* allocate(size_t t_bytes, size_t t_alignment);
+    // t_count elements, left uninitialized for trivial types
+    template <typename T>
+    Span<T> allocate(size_t t_count) {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+        T* items = static_cast<T*>(allocate(t_count * sizeof(T), alignof(T)));
+        std::uninitialized_default_construct_n(items, t_count);
+        return {items, t_count};
+    }
+
+    Marker mark() const;
+    void rewind(const Marker& t_marker);
+    // Frees everything, the blocks are kept for the next frame
+    void reset();
+
+    // Bytes handed out since the last reset, and the most seen in any frame
+    size_t bytesUsed() const { return m_used; }
+    size_t peakBytes() const { return m_peak; }
+    size_t capacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> m_data;
+        size_t m_size = 0;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_blockSize;
+    size_t m_current = 0;
+    size_t m_offset = 0;
+    size_t m_used = 0;
+    size_t m_peak = 0;
+};
+
+// Rewinds the arena when it goes out of scope, for scratch memory of a single call
+class ArenaScope {
+public:
+    explicit ArenaScope(FrameArena& t_arena) : m_arena(t_arena), m_marker(t_arena.mark()) {}
+    ~ArenaScope() { m_arena.rewind(m_marker); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    FrameArena& m_arena;
+    FrameArena::Marker m_marker;
+};
@@ -0,0 +1,14 @@
+#include "args.hpp"
+#include <cmath>
+
+bool args::parseReal(const std::string& t_text, double& t_value) {
+    try {
+        size_t used = 0;
+        double value = std::stod(t_text, &used);
+        if (used != t_text.size() || !std::isfinite(value) || value < 0.0) return false;
+        t_value = value;
+    } catch (const std::logic_error&) {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Command line number parsing shared by the app and the bench. Malformed values make the
+// parse fail so the caller can print its usage, nothing is thrown or silently truncated
+namespace args {
+    // Whole number of at least t_min that fits T. Signs, trailing text and out of range values are rejected
+    template <typename T>
+    bool parseWhole(const std::string& t_text, T t_min, T& t_value) {
+        if (t_text.empty() || !std::isdigit(static_cast<unsigned char>(t_text[0]))) return false;
+        try {
+            size_t used = 0;
+            unsigned long long value = std::stoull(t_text, &used);
+            if (used != t_text.size() || value < static_cast<unsigned long long>(t_min) ||
+                value > static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+                return false;
+            }
+            t_value = static_cast<T>(value);
+        } catch (const std::logic_error&) {
+            return false;
+        }
+        return true;
+    }
+
+    // Finite, non-negative number
+    bool parseReal(const std::string& t_text, double& t_value);
+}
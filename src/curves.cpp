@@ -0,0 +1,20 @@
+#include "curves.hpp"
+
+void curves::generate(const sine::SineParams& t_params, Spectrum& t_spectrum, VertexFormat t_format, FrameArena& t_arena,
+                      std::vector<uint8_t>& t_vertexData, std::vector<CurveRange>& t_curves) {
+    t_vertexData.clear();
+    t_curves.clear();
+    VertexDecode decode = sine::generateSineWave(t_params, t_format, t_vertexData);
+    t_curves.push_back({0, static_cast<uint32_t>(t_params.m_pointCount), decode});
+    if (!t_spectrum.m_enabled || t_params.m_pointCount < 2) {
+        return;
+    }
+
+    Span<float> samples = t_arena.allocate<float>(static_cast<size_t>(t_params.m_pointCount));
+    sine::sampleSineWave(t_params, samples);
+    fft::prepare(t_spectrum.m_plan, samples.size(), t_spectrum.m_window);
+    Span<float> decibels = t_arena.allocate<float>(fft::binCount(t_spectrum.m_plan));
+    fft::amplitudeSpectrum(t_spectrum.m_plan, samples, decibels);
+    decode = sine::packCurve(decibels, 2.0f / SPECTRUM_FLOOR_DB, -1.0f, t_format, t_vertexData);
+    t_curves.push_back({t_curves.back().m_vertexCount, static_cast<uint32_t>(decibels.size()), decode});
+}
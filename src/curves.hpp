@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include "arena.hpp"
+#include "fft.hpp"
+#include "sine.hpp"
+
+// What a frame draws: the sine and, when enabled, its spectrum, packed back to back.
+// Shared by the window, the frame export and the SVG export so they all show the same curves
+namespace curves {
+    // Spectrum curve range, 0 dB is drawn at the top of the view and this at the bottom
+    constexpr float SPECTRUM_FLOOR_DB = -140.0f;
+
+    // FFT of the sine, drawn as a second curve
+    struct Spectrum {
+        bool m_enabled = false;
+        fft::Window m_window = fft::Window::HANN;
+        // Tables and buffers kept between frames, so recomputing it doesn't allocate
+        fft::Plan m_plan;
+    };
+
+    // Packs the sine, and its spectrum when enabled, into t_vertexData with one range per curve.
+    // Scratch memory comes from t_arena
+    void generate(const sine::SineParams& t_params, Spectrum& t_spectrum, VertexFormat t_format, FrameArena& t_arena,
+                  std::vector<uint8_t>& t_vertexData, std::vector<CurveRange>& t_curves);
+}
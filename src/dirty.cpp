@@ -0,0 +1,32 @@
+#include "dirty.hpp"
+
+void dirty::mark(Tracker& t_tracker, uint32_t t_flags) {
+    t_tracker.m_flags |= t_flags;
+}
+
+bool dirty::needsRegeneration(const Tracker& t_tracker) {
+    return (t_tracker.m_flags & CURVE_PARAMS) != 0;
+}
+
+bool dirty::needsRedraw(const Tracker& t_tracker) {
+    return t_tracker.m_flags != NONE;
+}
+
+void dirty::endFrame(Tracker& t_tracker, bool t_submitted, bool t_retrySwapchain) {
+    Counters& c = t_tracker.m_counters;
+    ++c.m_loopIterations;
+    if (needsRegeneration(t_tracker)) ++c.m_regenerations; else ++c.m_regenerationsSkipped;
+    if (t_submitted) ++c.m_submits; else ++c.m_submitsSkipped;
+
+    // the vertices of a dropped frame (e.g. swapchain out of date) are already uploaded,
+    // only the redraw is still owed, also when the other windows got the frame
+    bool owed = t_retrySwapchain || (!t_submitted && needsRedraw(t_tracker));
+    t_tracker.m_flags = owed ? SWAPCHAIN : NONE;
+}
+
+void dirty::printCounters(std::ostream& t_out, const Counters& t_counters) {
+    t_out << "Frames: " << t_counters.m_loopIterations << " loop iterations, "
+          << t_counters.m_submits << " submitted, " << t_counters.m_submitsSkipped << " skipped\n"
+          << "Regenerations: " << t_counters.m_regenerations << " done, " << t_counters.m_regenerationsSkipped << " skipped"
+          << std::endl;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+namespace dirty {
+    // Inputs of a frame, each one invalidates a different amount of work
+    enum Flags : uint32_t {
+        NONE = 0,
+        CURVE_PARAMS = 1u << 0, // amplitude, frequency, phase, point count or spectrum, needs regeneration
+        SWAPCHAIN = 1u << 1,    // resized or recreated, needs a redraw
+        VIEW = 1u << 2,         // view transform, needs a redraw only
+        ALL = CURVE_PARAMS | SWAPCHAIN | VIEW,
+    };
+
+    // How much work the frame loop did and how much it avoided
+    struct Counters {
+        uint64_t m_loopIterations = 0;
+        uint64_t m_regenerations = 0;
+        uint64_t m_regenerationsSkipped = 0;
+        uint64_t m_submits = 0;
+        uint64_t m_submitsSkipped = 0;
+    };
+
+    struct Tracker {
+        // everything is stale before the first frame
+        uint32_t m_flags = ALL;
+        Counters m_counters;
+    };
+
+    void mark(Tracker& t_tracker, uint32_t t_flags);
+    // Whether vertices have to be generated and uploaded again this frame
+    bool needsRegeneration(const Tracker& t_tracker);
+    // Whether anything at all changed since the last submitted frame
+    bool needsRedraw(const Tracker& t_tracker);
+    // Updates the counters from the current flags and clears them, call once per loop iteration.
+    // t_retrySwapchain keeps a redraw owed for windows whose swapchain wasn't ready
+    void endFrame(Tracker& t_tracker, bool t_submitted, bool t_retrySwapchain);
+    void printCounters(std::ostream& t_out, const Counters& t_counters);
+}
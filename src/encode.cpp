@@ -0,0 +1,192 @@
+#include "encode.hpp"
+#include <algorithm>
+#include <array>
+
+// Slicing-by-8: table k advances the CRC of a byte followed by k zero bytes,
+// so eight bytes are folded in with eight independent lookups
+static const std::array<std::array<uint32_t, 256>, 8>& crcTables() {
+    static const std::array<std::array<uint32_t, 256>, 8> tables = [] {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; ++n) {
+            for (size_t k = 1; k < 8; ++k) {
+                t[k][n] = t[0][t[k - 1][n] & 0xFF] ^ (t[k - 1][n] >> 8);
+            }
+        }
+        return t;
+    }();
+    return tables;
+}
+
+static uint32_t crc32(const uint8_t* t_data, size_t t_size, uint32_t t_crc = 0xFFFFFFFFu) {
+    const auto& t = crcTables();
+    for (; t_size >= 8; t_data += 8, t_size -= 8) {
+        uint32_t lo = t_crc ^ (static_cast<uint32_t>(t_data[0]) | static_cast<uint32_t>(t_data[1]) << 8 |
+                               static_cast<uint32_t>(t_data[2]) << 16 | static_cast<uint32_t>(t_data[3]) << 24);
+        t_crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                t[3][t_data[4]] ^ t[2][t_data[5]] ^ t[1][t_data[6]] ^ t[0][t_data[7]];
+    }
+    for (size_t i = 0; i < t_size; ++i) {
+        t_crc = t[0][(t_crc ^ t_data[i]) & 0xFF] ^ (t_crc >> 8);
+    }
+    return t_crc;
+}
+
+// Largest run whose sums can't overflow 32 bits before the modulo, the same bound zlib uses
+static constexpr size_t ADLER_RUN = 5552;
+static constexpr uint32_t ADLER_MOD = 65521;
+
+static void adler32(uint32_t& t_a, uint32_t& t_b, const uint8_t* t_data, size_t t_size) {
+    while (t_size > 0) {
+        size_t run = std::min(t_size, ADLER_RUN);
+        for (size_t i = 0; i < run; ++i) {
+            t_a += t_data[i];
+            t_b += t_a;
+        }
+        t_a %= ADLER_MOD;
+        t_b %= ADLER_MOD;
+        t_data += run;
+        t_size -= run;
+    }
+}
+
+static void putU32BE(std::vector<uint8_t>& t_out, uint32_t t_value) {
+    t_out.push_back(static_cast<uint8_t>(t_value >> 24));
+    t_out.push_back(static_cast<uint8_t>(t_value >> 16));
+    t_out.push_back(static_cast<uint8_t>(t_value >> 8));
+    t_out.push_back(static_cast<uint8_t>(t_value));
+}
+
+static void writeChunk(std::vector<uint8_t>& t_out, const char* t_type, const uint8_t* t_data, size_t t_size) {
+    putU32BE(t_out, static_cast<uint32_t>(t_size));
+    size_t typeStart = t_out.size();
+    t_out.insert(t_out.end(), t_type, t_type + 4);
+    t_out.insert(t_out.end(), t_data, t_data + t_size);
+    uint32_t crc = crc32(t_out.data() + typeStart, t_size + 4) ^ 0xFFFFFFFFu;
+    putU32BE(t_out, crc);
+}
+
+void encode::encodePng(const uint8_t* t_rgba, uint32_t t_width, uint32_t t_height, std::vector<uint8_t>& t_out) {
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    t_out.clear();
+    t_out.insert(t_out.end(), signature, signature + sizeof(signature));
+
+    uint8_t ihdr[13] = {};
+    std::vector<uint8_t> header;
+    putU32BE(header, t_width);
+    putU32BE(header, t_height);
+    std::copy(header.begin(), header.end(), ihdr);
+    ihdr[8] = 8;  // bit depth
+    ihdr[9] = 2;  // color type RGB
+    writeChunk(t_out, "IHDR", ihdr, sizeof(ihdr));
+
+    // Filter type 0 per row followed by the RGB samples
+    const size_t rowSize = 1 + static_cast<size_t>(t_width) * 3;
+    const size_t rawSize = rowSize * t_height;
+
+    // zlib header, stored deflate blocks (max 65535 bytes each), adler32 of the raw data
+    const size_t blockCount = std::max<size_t>(1, (rawSize + 65534) / 65535);
+    std::vector<uint8_t> idat;
+    idat.reserve(2 + rawSize + blockCount * 5 + 4);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+
+    uint32_t adlerA = 1, adlerB = 0;
+    size_t blockLeft = 0;
+    size_t written = 0;
+    // Appends a span of raw bytes, starting a new stored block whenever the current one is full
+    auto putRaw = [&](const uint8_t* t_data, size_t t_size) {
+        adler32(adlerA, adlerB, t_data, t_size);
+        while (t_size > 0) {
+            if (blockLeft == 0) {
+                size_t len = std::min<size_t>(65535, rawSize - written);
+                idat.push_back(written + len == rawSize ? 1 : 0);
+                idat.push_back(static_cast<uint8_t>(len));
+                idat.push_back(static_cast<uint8_t>(len >> 8));
+                idat.push_back(static_cast<uint8_t>(~len));
+                idat.push_back(static_cast<uint8_t>(~len >> 8));
+                blockLeft = len;
+            }
+            size_t count = std::min(t_size, blockLeft);
+            idat.insert(idat.end(), t_data, t_data + count);
+            t_data += count;
+            t_size -= count;
+            blockLeft -= count;
+            written += count;
+        }
+    };
+
+    // each row is packed to RGB once, then copied into the blocks in as few pieces as possible
+    std::vector<uint8_t> row(rowSize);
+    row[0] = 0;
+    for (uint32_t y = 0; y < t_height; ++y) {
+        const uint8_t* src = t_rgba + static_cast<size_t>(y) * t_width * 4;
+        uint8_t* dst = row.data() + 1;
+        for (uint32_t x = 0; x < t_width; ++x) {
+            dst[x * 3] = src[x * 4];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+        putRaw(row.data(), rowSize);
+    }
+    putU32BE(idat, (adlerB << 16) | adlerA);
+
+    writeChunk(t_out, "IDAT", idat.data(), idat.size());
+    writeChunk(t_out, "IEND", nullptr, 0);
+}
+
+std::string encode::y4mHeader(uint32_t t_width, uint32_t t_height, uint32_t t_fps) {
+    // The frames are full range, readers assume limited range unless told otherwise
+    return "YUV4MPEG2 W" + std::to_string(t_width) + " H" + std::to_string(t_height) +
+           " F" + std::to_string(t_fps) + ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+}
+
+void encode::encodeY4mFrame(const uint8_t* t_rgba, uint32_t t_width, uint32_t t_height, std::vector<uint8_t>& t_out) {
+    static const char marker[] = "FRAME\n";
+    const uint32_t chromaWidth = (t_width + 1) / 2;
+    const uint32_t chromaHeight = (t_height + 1) / 2;
+    const size_t lumaSize = static_cast<size_t>(t_width) * t_height;
+    const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    t_out.resize(sizeof(marker) - 1 + lumaSize + 2 * chromaSize);
+    std::copy(marker, marker + sizeof(marker) - 1, t_out.begin());
+    uint8_t* yPlane = t_out.data() + sizeof(marker) - 1;
+    uint8_t* uPlane = yPlane + lumaSize;
+    uint8_t* vPlane = uPlane + chromaSize;
+
+    // Full range BT.601 in 8.8 fixed point
+    for (uint32_t y = 0; y < t_height; ++y) {
+        const uint8_t* row = t_rgba + static_cast<size_t>(y) * t_width * 4;
+        for (uint32_t x = 0; x < t_width; ++x) {
+            int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+            yPlane[static_cast<size_t>(y) * t_width + x] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+
+    // Chroma from the average of each 2x2 block, edges reuse the last row/column
+    for (uint32_t cy = 0; cy < chromaHeight; ++cy) {
+        for (uint32_t cx = 0; cx < chromaWidth; ++cx) {
+            int r = 0, g = 0, b = 0;
+            for (uint32_t dy = 0; dy < 2; ++dy) {
+                for (uint32_t dx = 0; dx < 2; ++dx) {
+                    uint32_t px = std::min(cx * 2 + dx, t_width - 1);
+                    uint32_t py = std::min(cy * 2 + dy, t_height - 1);
+                    const uint8_t* p = t_rgba + (static_cast<size_t>(py) * t_width + px) * 4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            size_t i = static_cast<size_t>(cy) * chromaWidth + cx;
+            // sums are 4x the average, hence the >> 10 instead of >> 8
+            uPlane[i] = static_cast<uint8_t>(std::clamp(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128, 0, 255));
+            vPlane[i] = static_cast<uint8_t>(std::clamp(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128, 0, 255));
+        }
+    }
+}
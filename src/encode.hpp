@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace encode {
+    // Encodes tightly packed RGBA8 pixels as an RGB PNG. The zlib stream uses stored blocks, so
+    // encoding is an RGB repack, block copies and the two checksums, at the cost of file size
+    void encodePng(const uint8_t* t_rgba, uint32_t t_width, uint32_t t_height, std::vector<uint8_t>& t_out);
+    // Stream header of a YUV4MPEG2 file, written once before the first frame
+    std::string y4mHeader(uint32_t t_width, uint32_t t_height, uint32_t t_fps);
+    // Converts RGBA8 pixels into one Y4M frame (FRAME marker + full range BT.601 I420 planes)
+    void encodeY4mFrame(const uint8_t* t_rgba, uint32_t t_width, uint32_t t_height, std::vector<uint8_t>& t_out);
+}
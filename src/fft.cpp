@@ -0,0 +1,329 @@
+#include "fft.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+static constexpr double PI = 3.14159265358979323846;
+// Floor of the spectrum, keeps log10 away from 0
+static constexpr float MIN_AMPLITUDE = 1e-7f;
+
+static size_t nextPowerOfTwo(size_t t_value) {
+    size_t size = 2;
+    while (size < t_value) {
+        size <<= 1;
+    }
+    return size;
+}
+
+static void buildWindow(fft::Plan& t_plan) {
+    const size_t n = t_plan.m_sampleCount;
+    t_plan.m_windowCoefficients.resize(n);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double t = n > 1 ? static_cast<double>(i) / static_cast<double>(n - 1) : 0.0;
+        double w = 1.0;
+        switch (t_plan.m_window) {
+            case fft::Window::RECTANGULAR: w = 1.0; break;
+            case fft::Window::HANN: w = 0.5 - 0.5 * std::cos(2.0 * PI * t); break;
+            case fft::Window::BLACKMAN: w = 0.42 - 0.5 * std::cos(2.0 * PI * t) + 0.08 * std::cos(4.0 * PI * t); break;
+        }
+        t_plan.m_windowCoefficients[i] = static_cast<float>(w);
+        sum += w;
+    }
+    // a sine of amplitude A peaks at A * sum / 2 in its bin
+    t_plan.m_amplitudeScale = sum > 0.0 ? static_cast<float>(2.0 / sum) : 1.0f;
+}
+
+static void buildTables(fft::Plan& t_plan) {
+    const size_t half = t_plan.m_size / 2;
+
+    // Same stage order transform() walks, a trailing radix-2 stage (n = 2) needs no twiddles
+    t_plan.m_twiddles.clear();
+    for (size_t n = half; n >= 4; n >>= 2) {
+        const size_t m = n / 4;
+        for (size_t power = 1; power <= 3; ++power) {
+            for (size_t p = 0; p < m; ++p) {
+                double angle = -2.0 * PI * static_cast<double>(power * p) / static_cast<double>(n);
+                t_plan.m_twiddles.push_back(static_cast<float>(std::cos(angle)));
+            }
+            for (size_t p = 0; p < m; ++p) {
+                double angle = -2.0 * PI * static_cast<double>(power * p) / static_cast<double>(n);
+                t_plan.m_twiddles.push_back(static_cast<float>(std::sin(angle)));
+            }
+        }
+    }
+
+    t_plan.m_splitRe.resize(half + 1);
+    t_plan.m_splitIm.resize(half + 1);
+    for (size_t k = 0; k <= half; ++k) {
+        double angle = -2.0 * PI * static_cast<double>(k) / static_cast<double>(t_plan.m_size);
+        t_plan.m_splitRe[k] = static_cast<float>(std::cos(angle));
+        t_plan.m_splitIm[k] = static_cast<float>(std::sin(angle));
+    }
+
+    t_plan.m_re.resize(half);
+    t_plan.m_im.resize(half);
+    t_plan.m_scratchRe.resize(half);
+    t_plan.m_scratchIm.resize(half);
+}
+
+void fft::prepare(Plan& t_plan, size_t t_sampleCount, Window t_window) {
+    size_t size = nextPowerOfTwo(t_sampleCount);
+    bool windowChanged = t_sampleCount != t_plan.m_sampleCount || t_window != t_plan.m_window ||
+                         t_plan.m_windowCoefficients.size() != t_sampleCount;
+    t_plan.m_sampleCount = t_sampleCount;
+    t_plan.m_window = t_window;
+    if (windowChanged) {
+        buildWindow(t_plan);
+    }
+    if (size != t_plan.m_size) {
+        t_plan.m_size = size;
+        buildTables(t_plan);
+    }
+}
+
+namespace {
+    struct Complex {
+        float re, im;
+    };
+
+    inline Complex operator+(Complex a, Complex b) { return {a.re + b.re, a.im + b.im}; }
+    inline Complex operator-(Complex a, Complex b) { return {a.re - b.re, a.im - b.im}; }
+    inline Complex operator*(Complex a, Complex b) { return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re}; }
+
+    // exp(-2 i pi j p / n) for j = 1, 2, 3 of one p
+    struct Twiddles {
+        Complex m_w[3];
+    };
+
+    // t_table is one stage's part of Plan::m_twiddles, m = n / 4 entries per row
+    inline Twiddles loadTwiddles(const float* t_table, size_t t_m, size_t t_p) {
+        Twiddles twiddles;
+        for (size_t j = 0; j < 3; ++j) {
+            twiddles.m_w[j] = {t_table[2 * j * t_m + t_p], t_table[(2 * j + 1) * t_m + t_p]};
+        }
+        return twiddles;
+    }
+
+    // 4 point DFT, outputs 1 to 3 are rotated by the twiddles
+    inline void butterfly4(Complex a, Complex b, Complex c, Complex d, const Twiddles& t_twiddles, Complex* t_out) {
+        Complex sumAc = a + c, diffAc = a - c;
+        Complex sumBd = b + d;
+        // -i (b - d)
+        Complex rotBd = {b.im - d.im, d.re - b.re};
+        t_out[0] = sumAc + sumBd;
+        t_out[1] = (diffAc + rotBd) * t_twiddles.m_w[0];
+        t_out[2] = (sumAc - sumBd) * t_twiddles.m_w[1];
+        t_out[3] = (diffAc - rotBd) * t_twiddles.m_w[2];
+    }
+
+    // Two radix-4 stages on 16 values, the second stage's inputs never leave registers.
+    // Element r is read at r * t_inStride, and element 4 i + j of the result written at (4 i + j) * t_outStride
+    inline void butterfly16(const float* t_re, const float* t_im, size_t t_inStride, float* t_outRe, float* t_outIm,
+                            size_t t_outStride, const Twiddles* t_first, const Twiddles& t_second) {
+        Complex x[16], y[16], z[4];
+#pragma GCC unroll 16
+        for (size_t r = 0; r < 16; ++r) {
+            x[r] = {t_re[r * t_inStride], t_im[r * t_inStride]};
+        }
+#pragma GCC unroll 4
+        for (size_t k = 0; k < 4; ++k) {
+            butterfly4(x[k], x[k + 4], x[k + 8], x[k + 12], t_first[k], y + 4 * k);
+        }
+#pragma GCC unroll 4
+        for (size_t j = 0; j < 4; ++j) {
+            butterfly4(y[j], y[4 + j], y[8 + j], y[12 + j], t_second, z);
+#pragma GCC unroll 4
+            for (size_t i = 0; i < 4; ++i) {
+                t_outRe[(4 * i + j) * t_outStride] = z[i].re;
+                t_outIm[(4 * i + j) * t_outStride] = z[i].im;
+            }
+        }
+    }
+}
+
+// Stockham stages read one buffer pair and write the other in natural order, so there is no bit reversal
+// pass and all accesses stay sequential. A stage of length n and stride s turns each sequence of n values
+// into n / 4 (radix-4) or n / 16 (radix-16) shorter ones at stride 4 s or 16 s.
+// The q loops run over s contiguous values, which is what the compiler vectorizes. ivdep: the output rows
+// are s apart and a vector never crosses one, which it can't prove with s unknown
+static void radix4Stage(const float* __restrict t_re, const float* __restrict t_im, float* __restrict t_outRe,
+                        float* __restrict t_outIm, size_t t_n, size_t t_s, const float* t_twiddles) {
+    const size_t m = t_n / 4;
+    for (size_t p = 0; p < m; ++p) {
+        const Twiddles twiddles = loadTwiddles(t_twiddles, m, p);
+        const float* re = t_re + t_s * p;
+        const float* im = t_im + t_s * p;
+        float* outRe = t_outRe + t_s * 4 * p;
+        float* outIm = t_outIm + t_s * 4 * p;
+        const size_t stride = t_s * m;
+#pragma GCC ivdep
+        for (size_t q = 0; q < t_s; ++q) {
+            Complex y[4];
+            butterfly4({re[q], im[q]}, {re[q + stride], im[q + stride]}, {re[q + 2 * stride], im[q + 2 * stride]},
+                       {re[q + 3 * stride], im[q + 3 * stride]}, twiddles, y);
+            for (size_t j = 0; j < 4; ++j) {
+                outRe[q + t_s * j] = y[j].re;
+                outIm[q + t_s * j] = y[j].im;
+            }
+        }
+    }
+}
+
+// Two radix-4 stages in one pass over memory, halves the traffic of the transform
+static void radix16Stage(const float* __restrict t_re, const float* __restrict t_im, float* __restrict t_outRe,
+                         float* __restrict t_outIm, size_t t_n, size_t t_s, const float* t_twiddles) {
+    const size_t m = t_n / 16;
+    // the first stage has 4 m butterflies per sequence, the one for p + k m feeds input k of the second's p
+    const float* second = t_twiddles + 6 * 4 * m;
+    if (t_s == 1) {
+        // The first pass has no q to vectorize over, so it runs along p: the loads stay contiguous
+        // and the stores become interleaved
+#pragma GCC ivdep
+        for (size_t p = 0; p < m; ++p) {
+            Twiddles first[4];
+            for (size_t k = 0; k < 4; ++k) {
+                first[k] = loadTwiddles(t_twiddles, 4 * m, p + k * m);
+            }
+            butterfly16(t_re + p, t_im + p, m, t_outRe + 16 * p, t_outIm + 16 * p, 1, first, loadTwiddles(second, m, p));
+        }
+        return;
+    }
+    for (size_t p = 0; p < m; ++p) {
+        Twiddles first[4];
+        for (size_t k = 0; k < 4; ++k) {
+            first[k] = loadTwiddles(t_twiddles, 4 * m, p + k * m);
+        }
+        const Twiddles last = loadTwiddles(second, m, p);
+        const float* re = t_re + t_s * p;
+        const float* im = t_im + t_s * p;
+        float* outRe = t_outRe + t_s * 16 * p;
+        float* outIm = t_outIm + t_s * 16 * p;
+#pragma GCC ivdep
+        for (size_t q = 0; q < t_s; ++q) {
+            butterfly16(re + q, im + q, t_s * m, outRe + q, outIm + q, t_s, first, last);
+        }
+    }
+}
+
+// The last factor of odd powers of two, n = 2
+static void radix2Stage(const float* __restrict t_re, const float* __restrict t_im, float* __restrict t_outRe,
+                        float* __restrict t_outIm, size_t t_s) {
+    for (size_t q = 0; q < t_s; ++q) {
+        float aRe = t_re[q], aIm = t_im[q];
+        float bRe = t_re[q + t_s], bIm = t_im[q + t_s];
+        t_outRe[q] = aRe + bRe;
+        t_outIm[q] = aIm + bIm;
+        t_outRe[q + t_s] = aRe - bRe;
+        t_outIm[q + t_s] = aIm - bIm;
+    }
+}
+
+// Radix-16 passes while at least two radix-4 stages are left, then a radix-4 and a radix-2 stage for
+// the remaining factors. Returns the buffer pair holding the result
+static std::pair<float*, float*> transform(fft::Plan& t_plan) {
+    const size_t half = t_plan.m_size / 2;
+    float* re = t_plan.m_re.data();
+    float* im = t_plan.m_im.data();
+    float* outRe = t_plan.m_scratchRe.data();
+    float* outIm = t_plan.m_scratchIm.data();
+    const float* twiddles = t_plan.m_twiddles.data();
+
+    size_t n = half;
+    size_t s = 1;
+    for (; n >= 16; n /= 16, s *= 16) {
+        radix16Stage(re, im, outRe, outIm, n, s, twiddles);
+        twiddles += 6 * (n / 4) + 6 * (n / 16);
+        std::swap(re, outRe);
+        std::swap(im, outIm);
+    }
+    if (n >= 4) {
+        radix4Stage(re, im, outRe, outIm, n, s, twiddles);
+        n /= 4;
+        s *= 4;
+        std::swap(re, outRe);
+        std::swap(im, outIm);
+    }
+
+    if (n == 2) {
+        radix2Stage(re, im, outRe, outIm, s);
+        std::swap(re, outRe);
+        std::swap(im, outIm);
+    }
+    return {re, im};
+}
+
+// log2 from the float's exponent plus a cubic fit of the mantissa, within 0.01 dB of the exact value
+static float fastLog2(float t_value) {
+    uint32_t bits;
+    std::memcpy(&bits, &t_value, sizeof(bits));
+    float exponent = static_cast<float>(static_cast<int32_t>((bits >> 23) & 0xff) - 127);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    // mantissa in [1, 2)
+    float log2Mantissa = ((0.15824871f * mantissa - 1.05187502f) * mantissa + 3.04788069f) * mantissa - 2.15427867f;
+    return exponent + log2Mantissa;
+}
+
+// Splits the half length result into the spectrum of the real input, in dB:
+// X[k] = E[k] + exp(-2 i pi k / N) O[k], with E and O taken from Z[k] and conj(Z[half - k])
+static void splitToDecibels(const fft::Plan& t_plan, const float* __restrict t_re, const float* __restrict t_im,
+                            float* __restrict t_out) {
+    const size_t half = t_plan.m_size / 2;
+    const float* splitRe = t_plan.m_splitRe.data();
+    const float* splitIm = t_plan.m_splitIm.data();
+    // dB from the squared amplitude, saves the square root: 10 log10(p) = 10 log10(2) log2(p)
+    const float dbPerOctave = 3.01029996f;
+    const float powerScale = t_plan.m_amplitudeScale * t_plan.m_amplitudeScale;
+    const float minPower = MIN_AMPLITUDE * MIN_AMPLITUDE;
+    // Z[half] wraps around to Z[0], so the ends are done separately and the loop needs no modulo.
+    // DC and Nyquist have no mirrored bin to share their energy with, they take 1 / sum instead of 2 / sum
+    const float edgePowerScale = 0.25f * powerScale;
+    t_out[0] = dbPerOctave * fastLog2(std::max((t_re[0] + t_im[0]) * (t_re[0] + t_im[0]) * edgePowerScale, minPower));
+    t_out[half] = dbPerOctave * fastLog2(std::max((t_re[0] - t_im[0]) * (t_re[0] - t_im[0]) * edgePowerScale, minPower));
+    for (size_t k = 1; k < half; ++k) {
+        size_t b = half - k;
+        float evenRe = 0.5f * (t_re[k] + t_re[b]);
+        float evenIm = 0.5f * (t_im[k] - t_im[b]);
+        float oddRe = 0.5f * (t_im[k] + t_im[b]);
+        float oddIm = 0.5f * (t_re[b] - t_re[k]);
+        float xr = evenRe + splitRe[k] * oddRe - splitIm[k] * oddIm;
+        float xi = evenIm + splitRe[k] * oddIm + splitIm[k] * oddRe;
+        // adding the floor instead of clamping to it keeps the loop free of branches, so it vectorizes.
+        // Only values within a few dB of the floor move
+        t_out[k] = dbPerOctave * fastLog2((xr * xr + xi * xi) * powerScale + minPower);
+    }
+}
+
+size_t fft::binCount(const Plan& t_plan) {
+    return t_plan.m_size / 2 + 1;
+}
+
+void fft::amplitudeSpectrum(Plan& t_plan, Span<const float> t_samples, Span<float> t_decibels) {
+    const size_t half = t_plan.m_size / 2;
+    const size_t count = t_plan.m_sampleCount;
+    const float* window = t_plan.m_windowCoefficients.data();
+    if (t_samples.size() != count || t_decibels.size() < binCount(t_plan)) {
+        throw std::invalid_argument("Spectrum buffers don't match the plan");
+    }
+
+    // Even samples become the real parts, odd ones the imaginary parts
+    float* packRe = t_plan.m_re.data();
+    float* packIm = t_plan.m_im.data();
+    const size_t pairs = count / 2;
+    for (size_t i = 0; i < pairs; ++i) {
+        packRe[i] = t_samples[2 * i] * window[2 * i];
+        packIm[i] = t_samples[2 * i + 1] * window[2 * i + 1];
+    }
+    for (size_t i = pairs; i < half; ++i) {
+        size_t even = 2 * i;
+        packRe[i] = even < count ? t_samples[even] * window[even] : 0.0f;
+        packIm[i] = 0.0f;
+    }
+
+    auto [re, im] = transform(t_plan);
+    splitToDecibels(t_plan, re, im, t_decibels.data());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "arena.hpp"
+
+// Spectrum of a real signal, Stockham FFT over precomputed tables. Radix-4 stages are fused in pairs
+// so the transform makes half as many passes over memory
+namespace fft {
+    enum class Window {
+        RECTANGULAR,
+        HANN,     // -31 dB side lobes, the usual choice
+        BLACKMAN, // -58 dB side lobes, wider main lobe
+    };
+
+    // Tables for one sample count and window, plus the work buffers. Built once and reused every
+    // frame, so a transform doesn't allocate. Real and imaginary parts live in separate arrays
+    // so the butterfly loops run over contiguous floats the compiler can vectorize
+    struct Plan {
+        size_t m_sampleCount = 0;
+        // Transform length, the samples are zero padded up to it
+        size_t m_size = 0;
+        Window m_window = Window::HANN;
+
+        std::vector<float> m_windowCoefficients;
+        // Undoes the window's attenuation, a full scale sine reads 0 dB
+        float m_amplitudeScale = 1.0f;
+
+        // The real input is transformed as m_size / 2 complex values. Per radix-4 stage of
+        // length n: exp(-2 i pi j p / n) for j = 1, 2, 3 and p < n / 4, real then imaginary parts
+        std::vector<float> m_twiddles;
+        // exp(-2 i pi k / m_size), splits the half length result into the real input's spectrum
+        std::vector<float> m_splitRe;
+        std::vector<float> m_splitIm;
+
+        // Stages ping-pong between the two buffer pairs
+        std::vector<float> m_re;
+        std::vector<float> m_im;
+        std::vector<float> m_scratchRe;
+        std::vector<float> m_scratchIm;
+    };
+
+    // Readies t_plan for t_sampleCount samples, the tables are only rebuilt when something changed
+    void prepare(Plan& t_plan, size_t t_sampleCount, Window t_window);
+    // Number of spectrum bins, m_size / 2 + 1. Bin k lies at k / m_size of the sample rate
+    size_t binCount(const Plan& t_plan);
+    // Windowed amplitude spectrum of t_plan.m_sampleCount samples in dB relative to full scale 1.0.
+    // t_decibels needs room for binCount() values
+    void amplitudeSpectrum(Plan& t_plan, Span<const float> t_samples, Span<float> t_decibels);
+}
@@ -0,0 +1,67 @@
+#include "pacing.hpp"
+#include <cmath>
+#include <thread>
+#include <GLFW/glfw3.h>
+
+// Longest wait for events when nothing needs drawing and no frame rate is set
+static constexpr double IDLE_TIMEOUT = 1.0 / 60.0;
+
+void pacing::requestRedraw(FramePacer& t_pacer) {
+    t_pacer.m_redrawRequested = true;
+}
+
+bool pacing::waitForNextFrame(FramePacer& t_pacer) {
+    if (t_pacer.m_onDemand && !t_pacer.m_redrawRequested) {
+        // Blocks without using the CPU until the OS delivers an event
+        glfwWaitEvents();
+    } else {
+        glfwPollEvents();
+    }
+
+    if (t_pacer.m_onDemand && !t_pacer.m_redrawRequested) {
+        return false;
+    }
+    t_pacer.m_redrawRequested = false;
+
+    if (t_pacer.m_targetFps > 0.0) {
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / t_pacer.m_targetFps));
+        auto now = Clock::now();
+        // Don't try to catch up after a stall (or on the first frame), restart the cadence instead
+        if (t_pacer.m_nextFrame + period < now) {
+            t_pacer.m_nextFrame = now;
+        }
+        preciseSleepUntil(t_pacer, t_pacer.m_nextFrame);
+        t_pacer.m_nextFrame += period;
+    }
+    return true;
+}
+
+void pacing::idle(const FramePacer& t_pacer) {
+    glfwWaitEventsTimeout(t_pacer.m_targetFps > 0.0 ? 1.0 / t_pacer.m_targetFps : IDLE_TIMEOUT);
+}
+
+void pacing::preciseSleepUntil(FramePacer& t_pacer, Clock::time_point t_deadline) {
+    using Seconds = std::chrono::duration<double>;
+
+    // Sleep in 1ms steps while the remaining time comfortably exceeds the observed oversleep
+    double remaining = Seconds(t_deadline - Clock::now()).count();
+    while (remaining > t_pacer.m_sleepEstimate) {
+        auto start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        double observed = Seconds(Clock::now() - start).count();
+        remaining -= observed;
+
+        // Welford update, estimate = mean + one standard deviation
+        ++t_pacer.m_sleepCount;
+        double delta = observed - t_pacer.m_sleepMean;
+        t_pacer.m_sleepMean += delta / static_cast<double>(t_pacer.m_sleepCount);
+        t_pacer.m_sleepM2 += delta * (observed - t_pacer.m_sleepMean);
+        double stddev = std::sqrt(t_pacer.m_sleepM2 / static_cast<double>(t_pacer.m_sleepCount - 1));
+        t_pacer.m_sleepEstimate = t_pacer.m_sleepMean + stddev;
+    }
+
+    // Spin for the last stretch, a sleep would likely overshoot it
+    while (Clock::now() < t_deadline) {
+        std::this_thread::yield();
+    }
+}
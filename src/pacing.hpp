@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+
+namespace pacing {
+    using Clock = std::chrono::steady_clock;
+
+    // Decides when the main loop renders, and how it waits in between
+    struct FramePacer {
+        // Only render when something asked for a redraw, sleep in glfwWaitEvents otherwise
+        bool m_onDemand = false;
+        // Upper bound on frames per second, 0 renders as fast as the present mode allows
+        double m_targetFps = 0.0;
+
+        bool m_redrawRequested = true;
+        Clock::time_point m_nextFrame{};
+        // Measured, mean plus one standard deviation of how long the 1ms sleeps so far actually took,
+        // oversleep included. preciseSleepUntil updates it after every sleep and spins instead once
+        // less than this is left
+        double m_sleepEstimate = 1e-3;
+        // Welford accumulators of the measured sleeps, seeded with one nominal 1ms sample
+        double m_sleepMean = 1e-3;
+        double m_sleepM2 = 0.0;
+        long long m_sleepCount = 1;
+    };
+
+    // Marks the next frame as needed, used by input and resize callbacks in on-demand mode
+    void requestRedraw(FramePacer& t_pacer);
+    // Processes window events and blocks until the next frame is due.
+    // Returns false when nothing needs to be rendered this iteration
+    bool waitForNextFrame(FramePacer& t_pacer);
+    // Waits for events for at most one frame period, used when a frame had nothing to draw
+    // so the loop doesn't spin on glfwPollEvents
+    void idle(const FramePacer& t_pacer);
+    // Sleeps until t_deadline, finishing with a short spin so wakeups land close to it
+    void preciseSleepUntil(FramePacer& t_pacer, Clock::time_point t_deadline);
+}
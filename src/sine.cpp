@@ -1,7 +1,10 @@
 #include "sine.hpp"
 #include <vector>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 
 // Generate sine wave animated on the horizontal axis
 std::vector<Vertex> sine::generateSineWave(float t_amplitude, float t_frequency, float t_phase, int t_pointCount) {
@@ -12,4 +15,177 @@ std::vector<Vertex> sine::generateSineWave(float t_amplitude, float t_frequency,
         sineVertices.push_back({ glm::vec2(x, y) });
     }
     return sineVertices;
-}
\ No newline at end of file
+}
+
+size_t sine::vertexStride(VertexFormat t_format) {
+    switch (t_format) {
+        case VertexFormat::FLOAT2: return sizeof(Vertex);
+        case VertexFormat::HALF2: return 2 * sizeof(uint16_t);
+        case VertexFormat::FLOAT_Y: return sizeof(float);
+        case VertexFormat::HALF_Y: return sizeof(uint16_t);
+        case VertexFormat::SNORM16_Y: return sizeof(uint16_t);
+    }
+    return sizeof(Vertex);
+}
+
+bool sine::isYOnly(VertexFormat t_format) {
+    return t_format == VertexFormat::FLOAT_Y || t_format == VertexFormat::HALF_Y || t_format == VertexFormat::SNORM16_Y;
+}
+
+glm::vec2 sine::decodePosition(const uint8_t* t_vertices, VertexFormat t_format, const VertexDecode& t_decode, uint32_t t_index) {
+    const uint8_t* src = t_vertices + vertexStride(t_format) * t_index;
+    glm::vec2 position(t_decode.m_xStart + static_cast<float>(t_index) * t_decode.m_xStep, 0.0f);
+    switch (t_format) {
+        case VertexFormat::FLOAT2:
+            std::memcpy(&position, src, sizeof(position));
+            break;
+        case VertexFormat::HALF2: {
+            uint16_t packed[2];
+            std::memcpy(packed, src, sizeof(packed));
+            position = glm::vec2(glm::unpackHalf1x16(packed[0]), glm::unpackHalf1x16(packed[1]));
+            break;
+        }
+        case VertexFormat::FLOAT_Y:
+            std::memcpy(&position.y, src, sizeof(float));
+            break;
+        case VertexFormat::HALF_Y:
+        case VertexFormat::SNORM16_Y: {
+            uint16_t packed;
+            std::memcpy(&packed, src, sizeof(packed));
+            position.y = t_format == VertexFormat::HALF_Y ? glm::unpackHalf1x16(packed) : glm::unpackSnorm1x16(packed);
+            break;
+        }
+    }
+    position.y = position.y * t_decode.m_yScale + t_decode.m_yOffset;
+    return position;
+}
+
+// Evaluates the curve and hands every sample to t_store, which writes it in the target format
+template <typename T, typename Store>
+static void fillSamples(const sine::SineParams& t_params, uint8_t* t_dst, Store t_store) {
+    T* out = reinterpret_cast<T*>(t_dst);
+    for (int i = 0; i < t_params.m_pointCount; ++i) {
+        float x = static_cast<float>(i) / (t_params.m_pointCount - 1) * 2.0f - 1.0f; // [-1, 1]
+        float y = t_params.m_amplitude * sinf(t_params.m_frequency * x * 2.0f * M_PI + t_params.m_phase);
+        t_store(out, i, x, y);
+    }
+}
+
+VertexDecode sine::generateSineWave(const SineParams& t_params, VertexFormat t_format, std::vector<uint8_t>& t_out) {
+    const size_t stride = vertexStride(t_format);
+    const size_t base = t_out.size();
+    t_out.resize(base + stride * t_params.m_pointCount);
+    uint8_t* dst = t_out.data() + base;
+
+    VertexDecode decode;
+    if (isYOnly(t_format)) {
+        decode.m_xStart = -1.0f;
+        decode.m_xStep = t_params.m_pointCount > 1 ? 2.0f / (t_params.m_pointCount - 1) : 0.0f;
+    }
+
+    switch (t_format) {
+        case VertexFormat::FLOAT2:
+            fillSamples<Vertex>(t_params, dst, [](Vertex* t_v, int t_i, float t_x, float t_y) {
+                t_v[t_i] = { glm::vec2(t_x, t_y) };
+            });
+            break;
+        case VertexFormat::HALF2:
+            fillSamples<uint16_t>(t_params, dst, [](uint16_t* t_v, int t_i, float t_x, float t_y) {
+                t_v[2 * t_i] = glm::packHalf1x16(t_x);
+                t_v[2 * t_i + 1] = glm::packHalf1x16(t_y);
+            });
+            break;
+        case VertexFormat::FLOAT_Y:
+            fillSamples<float>(t_params, dst, [](float* t_v, int t_i, float, float t_y) {
+                t_v[t_i] = t_y;
+            });
+            break;
+        case VertexFormat::HALF_Y:
+            fillSamples<uint16_t>(t_params, dst, [](uint16_t* t_v, int t_i, float, float t_y) {
+                t_v[t_i] = glm::packHalf1x16(t_y);
+            });
+            break;
+        case VertexFormat::SNORM16_Y: {
+            // Store y relative to the amplitude so the whole int16 range carries precision
+            float amplitude = std::fabs(t_params.m_amplitude);
+            decode.m_yScale = amplitude > 0.0f ? amplitude : 1.0f;
+            float invScale = 1.0f / decode.m_yScale;
+            fillSamples<uint16_t>(t_params, dst, [invScale](uint16_t* t_v, int t_i, float, float t_y) {
+                t_v[t_i] = glm::packSnorm1x16(t_y * invScale);
+            });
+            break;
+        }
+    }
+    return decode;
+}
+
+void sine::sampleSineWave(const SineParams& t_params, Span<float> t_y) {
+    const int count = std::min(t_params.m_pointCount, static_cast<int>(t_y.size()));
+    for (int i = 0; i < count; ++i) {
+        float x = static_cast<float>(i) / (t_params.m_pointCount - 1) * 2.0f - 1.0f; // [-1, 1]
+        t_y[i] = t_params.m_amplitude * sinf(t_params.m_frequency * x * 2.0f * M_PI + t_params.m_phase);
+    }
+}
+
+VertexDecode sine::packCurve(Span<const float> t_values, float t_yScale, float t_yOffset, VertexFormat t_format,
+                             std::vector<uint8_t>& t_out) {
+    const size_t count = t_values.size();
+    const size_t stride = vertexStride(t_format);
+    const size_t base = t_out.size();
+    t_out.resize(base + stride * count);
+    uint8_t* dst = t_out.data() + base;
+
+    const float xStep = count > 1 ? 2.0f / static_cast<float>(count - 1) : 0.0f;
+    VertexDecode decode;
+    if (isYOnly(t_format)) {
+        // the scale and offset ride along in the decode constants, the values are stored as they are
+        decode.m_xStart = -1.0f;
+        decode.m_xStep = xStep;
+        decode.m_yScale = t_yScale;
+        decode.m_yOffset = t_yOffset;
+    }
+
+    switch (t_format) {
+        case VertexFormat::FLOAT2: {
+            Vertex* out = reinterpret_cast<Vertex*>(dst);
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = { glm::vec2(-1.0f + static_cast<float>(i) * xStep, t_values[i] * t_yScale + t_yOffset) };
+            }
+            break;
+        }
+        case VertexFormat::HALF2: {
+            uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+            for (size_t i = 0; i < count; ++i) {
+                out[2 * i] = glm::packHalf1x16(-1.0f + static_cast<float>(i) * xStep);
+                out[2 * i + 1] = glm::packHalf1x16(t_values[i] * t_yScale + t_yOffset);
+            }
+            break;
+        }
+        case VertexFormat::FLOAT_Y:
+            std::memcpy(dst, t_values.data(), count * sizeof(float));
+            break;
+        case VertexFormat::HALF_Y: {
+            uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = glm::packHalf1x16(t_values[i]);
+            }
+            break;
+        }
+        case VertexFormat::SNORM16_Y: {
+            // Stored relative to the largest magnitude so the whole int16 range carries precision
+            float range = 0.0f;
+            for (size_t i = 0; i < count; ++i) {
+                range = std::max(range, std::fabs(t_values[i]));
+            }
+            range = range > 0.0f ? range : 1.0f;
+            decode.m_yScale = t_yScale * range;
+            float invRange = 1.0f / range;
+            uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = glm::packSnorm1x16(t_values[i] * invRange);
+            }
+            break;
+        }
+    }
+    return decode;
+}
@@ -1,12 +1,69 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
+#include "arena.hpp"
 
 struct Vertex {
     glm::vec2 position;
 };
 
+// How positions are stored in the vertex buffer. The y-only layouts drop x entirely,
+// line.vert derives it from gl_VertexIndex since the samples are evenly spaced
+enum class VertexFormat {
+    FLOAT2,    // Vertex, 8 bytes
+    HALF2,     // x and y as float16, 4 bytes
+    FLOAT_Y,   // y as float32, 4 bytes
+    HALF_Y,    // y as float16, 2 bytes
+    SNORM16_Y, // y as normalized int16 relative to the curve's amplitude, 2 bytes
+};
+
+// Per-curve constants line.vert needs to turn stored values back into world positions
+struct VertexDecode {
+    float m_xStart = 0.0f; // y-only formats: x = xStart + index * xStep
+    float m_xStep = 0.0f;
+    float m_yScale = 1.0f; // y = stored * yScale + yOffset
+    float m_yOffset = 0.0f;
+};
+
+// Range of vertices drawn as a single line strip
+struct CurveRange {
+    uint32_t m_firstVertex = 0;
+    uint32_t m_vertexCount = 0;
+    // How line.vert unpacks this curve, pushed before its draw
+    VertexDecode m_decode;
+};
+
 namespace sine {
+    // Everything that determines the generated vertices
+    struct SineParams {
+        float m_amplitude = 0.5f;
+        float m_frequency = 1.0f;
+        float m_phase = 0.0f;
+        int m_pointCount = 200;
+
+        bool operator==(const SineParams& t_other) const {
+            return m_amplitude == t_other.m_amplitude && m_frequency == t_other.m_frequency &&
+                   m_phase == t_other.m_phase && m_pointCount == t_other.m_pointCount;
+        }
+        bool operator!=(const SineParams& t_other) const { return !(*this == t_other); }
+    };
+
     std::vector<Vertex> generateSineWave(float t_amplitude, float t_frequency, float t_phase, int t_pointCount);
-}
\ No newline at end of file
+    // Appends the curve to t_out already packed in t_format, returns how to decode it
+    VertexDecode generateSineWave(const SineParams& t_params, VertexFormat t_format, std::vector<uint8_t>& t_out);
+    // Just the y values of the curve, for analysis on the CPU. t_y needs room for m_pointCount values
+    void sampleSineWave(const SineParams& t_params, Span<float> t_y);
+    // Appends evenly spaced values spanning x in [-1, 1] to t_out packed in t_format,
+    // drawn at y = value * t_yScale + t_yOffset. Returns how to decode them
+    VertexDecode packCurve(Span<const float> t_values, float t_yScale, float t_yOffset, VertexFormat t_format,
+                           std::vector<uint8_t>& t_out);
+
+    size_t vertexStride(VertexFormat t_format);
+    // Whether x is left out and derived from the vertex index
+    bool isYOnly(VertexFormat t_format);
+    // World position of vertex t_index of packed vertex data, the CPU side of what line.vert does
+    glm::vec2 decodePosition(const uint8_t* t_vertices, VertexFormat t_format, const VertexDecode& t_decode, uint32_t t_index);
+}
@@ -0,0 +1,179 @@
+#include "svg.hpp"
+#include "workers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+    // The render pass clear (0.1, 0.1, 0.1) and line.frag (1.0, 0.8, 0.2) are linear values written to sRGB
+    // images, SVG colors are sRGB already. These are those values encoded, so the file matches the window
+    constexpr const char* BACKGROUND_COLOR = "#595959";
+    constexpr const char* LINE_COLOR = "#ffe77c";
+
+    struct ChunkResult {
+        std::string m_text;
+        size_t m_points = 0;
+    };
+
+    float segmentDistanceSq(glm::vec2 t_point, glm::vec2 t_a, glm::vec2 t_b) {
+        glm::vec2 ab = t_b - t_a;
+        float lengthSq = glm::dot(ab, ab);
+        float t = lengthSq > 0.0f ? glm::clamp(glm::dot(t_point - t_a, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+        glm::vec2 d = t_point - (t_a + ab * t);
+        return glm::dot(d, d);
+    }
+
+    // Ramer-Douglas-Peucker with an explicit stack, marks the points to keep in t_keep
+    void simplify(const std::vector<glm::vec2>& t_points, float t_tolerance, std::vector<uint8_t>& t_keep) {
+        const size_t count = t_points.size();
+        t_keep.assign(count, t_tolerance > 0.0f ? 0 : 1);
+        if (count == 0 || t_tolerance <= 0.0f) {
+            return;
+        }
+        t_keep.front() = 1;
+        t_keep.back() = 1;
+
+        const float toleranceSq = t_tolerance * t_tolerance;
+        std::vector<std::pair<size_t, size_t>> stack{{0, count - 1}};
+        while (!stack.empty()) {
+            auto [first, last] = stack.back();
+            stack.pop_back();
+
+            float maxDistanceSq = toleranceSq;
+            size_t split = 0;
+            for (size_t i = first + 1; i < last; ++i) {
+                float distanceSq = segmentDistanceSq(t_points[i], t_points[first], t_points[last]);
+                if (distanceSq > maxDistanceSq) {
+                    maxDistanceSq = distanceSq;
+                    split = i;
+                }
+            }
+            if (split != 0) {
+                t_keep[split] = 1;
+                stack.push_back({first, split});
+                stack.push_back({split, last});
+            }
+        }
+    }
+
+    // Two decimals are plenty for pixel coordinates, and this is a lot cheaper than printf
+    void appendCoordinate(std::string& t_out, float t_value) {
+        if (!std::isfinite(t_value)) {
+            t_value = 0.0f;
+        }
+        long long hundredths = std::llround(std::clamp(t_value, -1e9f, 1e9f) * 100.0f);
+        if (hundredths < 0) {
+            t_out += '-';
+            hundredths = -hundredths;
+        }
+        char digits[24];
+        int length = 0;
+        long long whole = hundredths / 100;
+        do {
+            digits[length++] = static_cast<char>('0' + whole % 10);
+            whole /= 10;
+        } while (whole != 0);
+        while (length > 0) {
+            t_out += digits[--length];
+        }
+        int fraction = static_cast<int>(hundredths % 100);
+        if (fraction != 0) {
+            t_out += '.';
+            t_out += static_cast<char>('0' + fraction / 10);
+            if (fraction % 10 != 0) {
+                t_out += static_cast<char>('0' + fraction % 10);
+            }
+        }
+    }
+
+    // Simplifies points [t_begin, t_end] of the curve. Every chunk but the first leaves out its
+    // first point, the previous chunk already wrote it as its last
+    ChunkResult simplifyChunk(const svg::Options& t_options, const uint8_t* t_vertices, VertexFormat t_format,
+                              const CurveRange& t_curve, uint32_t t_begin, uint32_t t_end) {
+        const glm::vec2 size(static_cast<float>(t_options.m_width), static_cast<float>(t_options.m_height));
+        std::vector<glm::vec2> points;
+        points.reserve(t_end - t_begin + 1);
+        for (uint32_t i = t_begin; i <= t_end; ++i) {
+            glm::vec2 world = sine::decodePosition(t_vertices, t_format, t_curve.m_decode, t_curve.m_firstVertex + i);
+            glm::vec2 clip = world * t_options.m_view.m_scale + t_options.m_view.m_offset;
+            points.push_back((clip + glm::vec2(1.0f, 1.0f)) * 0.5f * size);
+        }
+
+        // simplified in output pixels, so the tolerance means the same at every zoom level
+        std::vector<uint8_t> keep;
+        simplify(points, t_options.m_tolerance, keep);
+
+        ChunkResult result;
+        for (size_t i = t_begin == 0 ? 0 : 1; i < points.size(); ++i) {
+            if (!keep[i]) {
+                continue;
+            }
+            result.m_text += ' ';
+            appendCoordinate(result.m_text, points[i].x);
+            result.m_text += ',';
+            appendCoordinate(result.m_text, points[i].y);
+            ++result.m_points;
+        }
+        return result;
+    }
+}
+
+svg::Stats svg::write(std::ostream& t_out, const Options& t_options, const uint8_t* t_vertices, VertexFormat t_format,
+                      const std::vector<CurveRange>& t_curves) {
+    const unsigned threadCount = t_options.m_threads ? t_options.m_threads
+                                                     : std::max(1u, std::thread::hardware_concurrency());
+    // at least two points per chunk, neighbouring chunks share one
+    const uint32_t chunkSize = std::max(2u, t_options.m_chunkSize);
+    const size_t maxInFlight = threadCount * 2;
+
+    Stats stats;
+    WorkerPool pool(threadCount, maxInFlight);
+    // Chunks handed to the pool, oldest first. Capped, so finished text can't pile up ahead of the stream
+    std::deque<std::future<ChunkResult>> pending;
+    auto writeOldest = [&] {
+        ChunkResult result = pending.front().get();
+        pending.pop_front();
+        t_out.write(result.m_text.data(), static_cast<std::streamsize>(result.m_text.size()));
+        stats.m_outputPoints += result.m_points;
+    };
+
+    t_out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << t_options.m_width << "\" height=\"" << t_options.m_height
+          << "\" viewBox=\"0 0 " << t_options.m_width << ' ' << t_options.m_height << "\">\n"
+          << "<rect width=\"100%\" height=\"100%\" fill=\"" << BACKGROUND_COLOR << "\"/>\n";
+
+    for (const auto& curve : t_curves) {
+        if (curve.m_vertexCount == 0) {
+            continue;
+        }
+        stats.m_inputPoints += curve.m_vertexCount;
+        t_out << "<polyline fill=\"none\" stroke=\"" << LINE_COLOR << "\" points=\"";
+
+        const uint32_t last = curve.m_vertexCount - 1;
+        uint32_t begin = 0;
+        do {
+            uint32_t end = std::min(last, begin + chunkSize - 1);
+            if (pending.size() >= maxInFlight) {
+                writeOldest();
+            }
+            auto task = std::make_shared<std::packaged_task<ChunkResult()>>([&t_options, t_vertices, t_format, curve, begin, end] {
+                return simplifyChunk(t_options, t_vertices, t_format, curve, begin, end);
+            });
+            pending.push_back(task->get_future());
+            pool.submit([task] { (*task)(); });
+            begin = end;
+        } while (begin < last);
+
+        while (!pending.empty()) {
+            writeOldest();
+        }
+        t_out << "\"/>\n";
+    }
+
+    t_out << "</svg>\n";
+    return stats;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "sine.hpp"
+#include "view.hpp"
+
+// Vector export of the curves as they are drawn, with the polylines simplified before writing
+namespace svg {
+    struct Options {
+        // Size of the document, clip space [-1, 1] maps onto it like onto the window
+        uint32_t m_width = 800;
+        uint32_t m_height = 600;
+        view::ViewTransform m_view;
+        // Furthest a dropped point may lie from the simplified line, in output pixels. 0 keeps every point
+        float m_tolerance = 0.25f;
+        // Points per simplification job. Jobs share their end points, so the line stays connected
+        uint32_t m_chunkSize = 1u << 16;
+        // Threads simplifying chunks, 0 uses every hardware thread
+        unsigned m_threads = 0;
+    };
+
+    struct Stats {
+        size_t m_inputPoints = 0;
+        size_t m_outputPoints = 0;
+    };
+
+    // Writes t_curves of the packed vertex data as one <polyline> each. Chunks are simplified
+    // in parallel and streamed to t_out in order, only a few of them are held at any time
+    Stats write(std::ostream& t_out, const Options& t_options, const uint8_t* t_vertices, VertexFormat t_format,
+                const std::vector<CurveRange>& t_curves);
+}
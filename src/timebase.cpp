@@ -0,0 +1,57 @@
+#include "timebase.hpp"
+#include <chrono>
+#include <cmath>
+
+static constexpr double TWO_PI = 6.283185307179586476925286766559;
+
+timebase::Ticks timebase::fromSeconds(double t_seconds) {
+    return static_cast<Ticks>(std::llround(t_seconds * static_cast<double>(TICKS_PER_SECOND)));
+}
+
+double timebase::toSeconds(Ticks t_ticks) {
+    // whole seconds and the remainder separately, each converts to double exactly
+    return static_cast<double>(t_ticks / TICKS_PER_SECOND) +
+           static_cast<double>(t_ticks % TICKS_PER_SECOND) / static_cast<double>(TICKS_PER_SECOND);
+}
+
+timebase::Ticks timebase::frameDuration(double t_fps) {
+    return t_fps > 0.0 ? fromSeconds(1.0 / t_fps) : 0;
+}
+
+timebase::Ticks timebase::frameTime(uint64_t t_frame, uint32_t t_fps) {
+    if (t_fps == 0) {
+        return 0;
+    }
+    // split like this the multiplication can't overflow for any realistic frame count
+    Ticks seconds = static_cast<Ticks>(t_frame / t_fps);
+    Ticks rest = static_cast<Ticks>(t_frame % t_fps);
+    return seconds * TICKS_PER_SECOND + rest * TICKS_PER_SECOND / t_fps;
+}
+
+timebase::Ticks timebase::wallNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void timebase::advance(Clock& t_clock, Ticks t_wallNow) {
+    Ticks elapsed = t_clock.m_started && !t_clock.m_wasPaused ? t_wallNow - t_clock.m_lastWall : 0;
+    t_clock.m_lastWall = t_wallNow;
+    t_clock.m_started = true;
+    t_clock.m_wasPaused = t_clock.m_paused;
+    if (t_clock.m_paused) {
+        return;
+    }
+    t_clock.m_now += t_clock.m_fixedStep > 0 ? t_clock.m_fixedStep : elapsed;
+}
+
+float timebase::phase(Ticks t_time, double t_radiansPerSecond) {
+    // Turns are wrapped before they are scaled to radians. Whole seconds and the sub-second
+    // remainder are wrapped separately, so the product never grows large enough to lose the fraction
+    double turnsPerSecond = t_radiansPerSecond / TWO_PI;
+    double wholeSeconds = static_cast<double>(t_time / TICKS_PER_SECOND);
+    double remainder = static_cast<double>(t_time % TICKS_PER_SECOND) / static_cast<double>(TICKS_PER_SECOND);
+    double turns = std::fmod(wholeSeconds * turnsPerSecond, 1.0) + std::fmod(remainder * turnsPerSecond, 1.0);
+    turns -= std::floor(turns);
+    float radians = static_cast<float>(turns * TWO_PI);
+    // rounding to float may land exactly on 2pi
+    return radians < static_cast<float>(TWO_PI) ? radians : 0.0f;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// Animation time kept in integer ticks, so it doesn't lose resolution however long the program runs.
+// Only the phase handed to the generator is a float, and that is wrapped into [0, 2pi) first
+namespace timebase {
+    using Ticks = int64_t;
+    // Nanoseconds, int64 covers ~292 years
+    constexpr Ticks TICKS_PER_SECOND = 1'000'000'000;
+
+    struct Clock {
+        Ticks m_now = 0;
+        bool m_paused = false;
+        // When set, every advance moves time by exactly this much instead of by the elapsed wall time.
+        // Playback is then the same on every run and every machine
+        Ticks m_fixedStep = 0;
+
+        Ticks m_lastWall = 0;
+        bool m_started = false;
+        // Paused at the previous advance. The wall time up to the first advance after resuming
+        // was spent paused, however long the app sat waiting for events
+        bool m_wasPaused = false;
+    };
+
+    Ticks fromSeconds(double t_seconds);
+    double toSeconds(Ticks t_ticks);
+    // Length of one frame at t_fps, rounded to the nearest tick
+    Ticks frameDuration(double t_fps);
+    // Time of frame t_frame at t_fps, exact for rates that divide a second into whole ticks
+    Ticks frameTime(uint64_t t_frame, uint32_t t_fps);
+    // Monotonic wall clock in ticks
+    Ticks wallNow();
+
+    // Moves the clock forward by the wall time since the previous call, or by the fixed step.
+    // Wall time passing while paused is skipped, so resuming continues where it stopped
+    void advance(Clock& t_clock, Ticks t_wallNow);
+    // Phase in [0, 2pi) of something turning at t_radiansPerSecond, t_time after phase 0
+    float phase(Ticks t_time, double t_radiansPerSecond);
+}
@@ -0,0 +1,26 @@
+#include "view.hpp"
+#include <glm/glm.hpp>
+
+// Keeps the scale within what float positions can still resolve
+static constexpr float MIN_SCALE = 1e-3f;
+static constexpr float MAX_SCALE = 1e5f;
+
+glm::vec2 view::windowToClip(double t_x, double t_y, int t_width, int t_height) {
+    // Vulkan clip space has y pointing down, same as window coordinates
+    return glm::vec2(static_cast<float>(t_x / t_width * 2.0 - 1.0),
+                     static_cast<float>(t_y / t_height * 2.0 - 1.0));
+}
+
+glm::vec2 view::clipToWorld(const ViewTransform& t_view, glm::vec2 t_clip) {
+    return (t_clip - t_view.m_offset) / t_view.m_scale;
+}
+
+void view::pan(ViewTransform& t_view, glm::vec2 t_clipDelta) {
+    t_view.m_offset += t_clipDelta;
+}
+
+void view::zoomAt(ViewTransform& t_view, glm::vec2 t_clipAnchor, float t_factor) {
+    glm::vec2 anchorWorld = clipToWorld(t_view, t_clipAnchor);
+    t_view.m_scale = glm::clamp(t_view.m_scale * t_factor, glm::vec2(MIN_SCALE), glm::vec2(MAX_SCALE));
+    t_view.m_offset = t_clipAnchor - anchorWorld * t_view.m_scale;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace view {
+    // World to clip space mapping applied in line.vert: clip = world * scale + offset.
+    // Laid out to match the push constant block, so it is pushed as is
+    struct ViewTransform {
+        glm::vec2 m_scale = glm::vec2(1.0f, 1.0f);
+        glm::vec2 m_offset = glm::vec2(0.0f, 0.0f);
+
+        bool operator==(const ViewTransform& t_other) const {
+            return m_scale == t_other.m_scale && m_offset == t_other.m_offset;
+        }
+        bool operator!=(const ViewTransform& t_other) const { return !(*this == t_other); }
+    };
+    static_assert(sizeof(ViewTransform) == 4 * sizeof(float), "ViewTransform must match the push constant block");
+
+    // Converts a cursor position in window coordinates into clip space
+    glm::vec2 windowToClip(double t_x, double t_y, int t_width, int t_height);
+    glm::vec2 clipToWorld(const ViewTransform& t_view, glm::vec2 t_clip);
+    // Moves the view by a distance given in clip space
+    void pan(ViewTransform& t_view, glm::vec2 t_clipDelta);
+    // Scales the view by t_factor while keeping the world point under t_clipAnchor in place
+    void zoomAt(ViewTransform& t_view, glm::vec2 t_clipAnchor, float t_factor);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running queued jobs in submission order.
+// submit blocks once t_maxPending jobs are waiting, which bounds the memory held by queued work
+class WorkerPool {
+public:
+    WorkerPool(unsigned t_threadCount, size_t t_maxPending);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> t_job);
+    // Blocks until every submitted job finished, rethrows the first exception a job threw
+    void wait();
+
+private:
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::condition_variable m_idle;
+    size_t m_maxPending;
+    size_t m_running = 0;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+};